@@ -4,7 +4,7 @@
 # Check if PLATFORM is provided (except for clean target)
 ifneq ($(MAKECMDGOALS),clean)
 ifndef PLATFORM
-$(error PLATFORM not specified. Usage: make PLATFORM=qemu or make PLATFORM=stm32)
+$(error PLATFORM not specified. Usage: make PLATFORM=qemu, make PLATFORM=stm32 or make PLATFORM=host)
 endif
 endif
 
@@ -25,8 +25,10 @@ ifeq ($(PLATFORM),stm32)
 include ../common/stm32f407.mk
 else ifeq ($(PLATFORM),qemu)
 include ../common/qemu.mk
+else ifeq ($(PLATFORM),host)
+include ../common/host.mk
 else
-$(error Invalid PLATFORM '$(PLATFORM)'. Valid platforms: qemu, stm32)
+$(error Invalid PLATFORM '$(PLATFORM)'. Valid platforms: qemu, stm32, host)
 endif
 endif
 
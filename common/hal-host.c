@@ -0,0 +1,72 @@
+#include <hal.h>
+#include <stdio.h>
+#include <signal.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Size of the region painted by hal_spraystack(); has to cover the deepest
+ * call that is measured (ML-DSA signing with the reference code). */
+#ifndef HOST_STACK_SPRAY_BYTES
+#define HOST_STACK_SPRAY_BYTES (512*1024)
+#endif
+
+void hal_setup(const enum clock_mode clock)
+{
+  (void) clock;
+  /* run-all-tests.sh stops reading at "ALL GOOD"; don't die on the rest */
+  signal(SIGPIPE, SIG_IGN);
+  setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+void hal_send_str(const char* in)
+{
+  fputs(in, stdout);
+  fputc('\n', stdout);
+}
+
+uint64_t hal_get_time(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+size_t hal_get_stack_size(void)
+{
+  return HOST_STACK_SPRAY_BYTES;
+}
+
+// Stack measurement implementation
+//
+// There is no linker-provided heap end on the host, so instead the region
+// directly below the caller's stack pointer is painted from within a frame of
+// HOST_STACK_SPRAY_BYTES bytes. The function measured next runs in the same
+// region; hal_checkstack() then counts the words that are still intact.
+static const uint32_t stackpattern = 0xDEADBEEFlu;
+static uintptr_t spray_base = 0;
+
+void __attribute__((noinline)) hal_spraystack(void) {
+    volatile uint32_t region[HOST_STACK_SPRAY_BYTES/4];
+    size_t i;
+
+    for(i = 0; i < HOST_STACK_SPRAY_BYTES/4; i++)
+        region[i] = stackpattern;
+    spray_base = (uintptr_t)region;
+}
+
+size_t __attribute__((noinline)) hal_checkstack(void) {
+    volatile uint32_t *region = (volatile uint32_t *)spray_base;
+    size_t i;
+
+    for(i = 0; i < HOST_STACK_SPRAY_BYTES/4; i++)
+        if(region[i] != stackpattern)
+            break;
+    return HOST_STACK_SPRAY_BYTES - 4*i;
+}
@@ -0,0 +1,36 @@
+all: elf/host.elf
+
+# Native build for functional testing and benchmarking on the development
+# machine. HOST_ARCH_FLAGS selects the vector extensions that the optional
+# host-only code paths (e.g., AVX2) are compiled for.
+CC		= gcc
+LD		= gcc
+
+HOST_ARCH_FLAGS ?= -march=native
+
+CFLAGS += -O3 \
+	-Wall -Wextra -Wimplicit-function-declaration \
+	-Wredundant-decls -Wmissing-prototypes -Wstrict-prototypes \
+	-Wundef -Wshadow \
+	$(HOST_ARCH_FLAGS) \
+	-I../common \
+	-fno-common -MD
+
+LDFLAGS += $(HOST_ARCH_FLAGS)
+
+LINKDEPS += obj/hal-host.c.o obj/randombytes.c.o $(PROJECT_OBJS)
+
+obj/hal-host.c.o: ../common/hal-host.c
+	@echo "  CC      $@"
+	$(Q)[ -d $(@D) ] || mkdir -p $(@D)
+	$(Q)$(CC) -c -o $@ $(CFLAGS) $<
+
+obj/randombytes.c.o: ../common/randombytes.c
+	@echo "  CC      $@"
+	$(Q)[ -d $(@D) ] || mkdir -p $(@D)
+	$(Q)$(CC) -c -o $@ $(CFLAGS) $<
+
+elf/host.elf: $(PROJECT_OBJS) obj/hal-host.c.o obj/randombytes.c.o obj/_ELFNAME_host.elf.o
+
+run-host: elf/host.elf
+	./elf/host.elf
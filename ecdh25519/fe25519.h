@@ -31,22 +31,13 @@ int fe25519_isnegative(const fe25519 *x);
 
 int fe25519_iseq(const fe25519 *x, const fe25519 *y);
 
-int fe25519_iseq_vartime(const fe25519 *x, const fe25519 *y);
-
 void fe25519_cmov(fe25519 *r, const fe25519 *x, unsigned char b);
 
-void fe25519_setone(fe25519 *r);
-
-void fe25519_setzero(fe25519 *r);
-
 void fe25519_neg(fe25519 *r, const fe25519 *x);
 
-unsigned char fe25519_getparity(const fe25519 *x);
-
 void fe25519_add(fe25519 *r, const fe25519 *x, const fe25519 *y);
 
 void fe25519_double(fe25519 *r, const fe25519 *x);
-void fe25519_triple(fe25519 *r, const fe25519 *x);
 
 void fe25519_sub(fe25519 *r, const fe25519 *x, const fe25519 *y);
 
@@ -54,12 +45,8 @@ void fe25519_mul(fe25519 *r, const fe25519 *x, const fe25519 *y);
 
 void fe25519_square(fe25519 *r, const fe25519 *x);
 
-void fe25519_invert(fe25519 *r, const fe25519 *x);
-
 void fe25519_pow2523(fe25519 *r, const fe25519 *x);
 
 void fe25519_invsqrt(fe25519 *r, const fe25519 *x);
 
-void fe25519_print(const fe25519 *x);
-
 #endif
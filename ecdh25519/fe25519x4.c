@@ -0,0 +1,222 @@
+#if defined(__AVX2__)
+#include "fe25519x4.h"
+
+/* Bit offset of limb i in radix 2^25.5 is ceil(25.5*i) */
+static const unsigned char limb_offset[10] = {0, 26, 51, 77, 102, 128, 153, 179, 204, 230};
+static const unsigned char limb_bits[10]   = {26, 25, 26, 25, 26, 25, 26, 25, 26, 25};
+
+/* 2*p in radix 2^25.5, added before subtraction to keep all lanes non-negative */
+static const uint64_t twop[10] = {0x7ffffda, 0x3fffffe, 0x7fffffe, 0x3fffffe, 0x7fffffe,
+                                  0x3fffffe, 0x7fffffe, 0x3fffffe, 0x7fffffe, 0x3fffffe};
+
+static __m256i times19(__m256i a)
+{
+  return _mm256_add_epi64(_mm256_add_epi64(_mm256_slli_epi64(a, 4), _mm256_slli_epi64(a, 1)), a);
+}
+
+static void carry(__m256i h[10])
+{
+  const __m256i mask26 = _mm256_set1_epi64x((1 << 26) - 1);
+  const __m256i mask25 = _mm256_set1_epi64x((1 << 25) - 1);
+  __m256i c;
+  int i;
+
+  for(i=0;i<9;i+=2)
+  {
+    c = _mm256_srli_epi64(h[i], 26);
+    h[i] = _mm256_and_si256(h[i], mask26);
+    h[i+1] = _mm256_add_epi64(h[i+1], c);
+
+    c = _mm256_srli_epi64(h[i+1], 25);
+    h[i+1] = _mm256_and_si256(h[i+1], mask25);
+    if(i < 8)
+      h[i+2] = _mm256_add_epi64(h[i+2], c);
+  }
+  h[0] = _mm256_add_epi64(h[0], times19(c));
+
+  c = _mm256_srli_epi64(h[0], 26);
+  h[0] = _mm256_and_si256(h[0], mask26);
+  h[1] = _mm256_add_epi64(h[1], c);
+}
+
+/* Splits a 255-bit little-endian byte string into radix 2^25.5 limbs */
+static void bytes_to_limbs(uint64_t r[10], const unsigned char x[32])
+{
+  uint64_t w[4] = {0};
+  unsigned int i, off;
+
+  for(i=0;i<32;i++)
+    w[i/8] |= (uint64_t)x[i] << (8*(i%8));
+  w[3] &= 0x7fffffffffffffffULL;
+
+  for(i=0;i<10;i++)
+  {
+    off = limb_offset[i];
+    r[i] = w[off/64] >> (off%64);
+    if(off%64 + limb_bits[i] > 64)
+      r[i] |= w[off/64+1] << (64 - off%64);
+    r[i] &= (1ULL << limb_bits[i]) - 1;
+  }
+}
+
+/* Inverse of bytes_to_limbs; fully carries the limbs first so that the
+ * result is below 2^255 (but not necessarily frozen) */
+static void limbs_to_bytes(unsigned char r[32], const uint64_t x[10])
+{
+  uint64_t t[10], w[4] = {0}, c;
+  unsigned int i, rep, off;
+
+  for(i=0;i<10;i++)
+    t[i] = x[i];
+
+  for(rep=0;rep<3;rep++)
+  {
+    for(i=0;i<9;i++)
+    {
+      c = t[i] >> limb_bits[i];
+      t[i] &= (1ULL << limb_bits[i]) - 1;
+      t[i+1] += c;
+    }
+    c = t[9] >> 25;
+    t[9] &= (1ULL << 25) - 1;
+    t[0] += 19*c;
+  }
+
+  for(i=0;i<10;i++)
+  {
+    off = limb_offset[i];
+    w[off/64] |= t[i] << (off%64);
+    if(off%64 + limb_bits[i] > 64)
+      w[off/64+1] |= t[i] >> (64 - off%64);
+  }
+
+  for(i=0;i<32;i++)
+    r[i] = w[i/8] >> (8*(i%8));
+}
+
+void fe25519x4_interleave(fe25519x4 *r, const fe25519 x[4])
+{
+  unsigned char b[32];
+  uint64_t t[4][10];
+  int i;
+
+  for(i=0;i<4;i++)
+  {
+    fe25519_pack(b, &x[i]);
+    bytes_to_limbs(t[i], b);
+  }
+  for(i=0;i<10;i++)
+    r->v[i] = _mm256_set_epi64x(t[3][i], t[2][i], t[1][i], t[0][i]);
+}
+
+void fe25519x4_deinterleave(fe25519 r[4], const fe25519x4 *x)
+{
+  unsigned char b[32];
+  uint64_t t[4][10];
+  int i;
+
+  for(i=0;i<10;i++)
+  {
+    t[0][i] = _mm256_extract_epi64(x->v[i], 0);
+    t[1][i] = _mm256_extract_epi64(x->v[i], 1);
+    t[2][i] = _mm256_extract_epi64(x->v[i], 2);
+    t[3][i] = _mm256_extract_epi64(x->v[i], 3);
+  }
+  for(i=0;i<4;i++)
+  {
+    limbs_to_bytes(b, t[i]);
+    fe25519_unpack(&r[i], b);
+  }
+}
+
+/* Lane k of r is replaced by lane k of x where lane k of mask is all ones */
+void fe25519x4_cmov(fe25519x4 *r, const fe25519x4 *x, __m256i mask)
+{
+  int i;
+  for(i=0;i<10;i++)
+    r->v[i] = _mm256_blendv_epi8(r->v[i], x->v[i], mask);
+}
+
+void fe25519x4_add(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y)
+{
+  int i;
+  for(i=0;i<10;i++)
+    r->v[i] = _mm256_add_epi64(x->v[i], y->v[i]);
+  carry(r->v);
+}
+
+void fe25519x4_sub(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y)
+{
+  int i;
+  for(i=0;i<10;i++)
+    r->v[i] = _mm256_sub_epi64(_mm256_add_epi64(x->v[i], _mm256_set1_epi64x(twop[i])), y->v[i]);
+  carry(r->v);
+}
+
+void fe25519x4_neg(fe25519x4 *r, const fe25519x4 *x)
+{
+  int i;
+  for(i=0;i<10;i++)
+    r->v[i] = _mm256_sub_epi64(_mm256_set1_epi64x(twop[i]), x->v[i]);
+  carry(r->v);
+}
+
+/* Schoolbook multiplication; products of two odd limbs carry an extra
+ * factor 2, products landing at or above 2^255 are folded back times 19. */
+void fe25519x4_mul(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y)
+{
+  __m256i h[10], x2[10], y19[10];
+  __m256i a, b;
+  int i,j;
+
+  for(i=0;i<10;i++)
+  {
+    h[i] = _mm256_setzero_si256();
+    x2[i] = _mm256_add_epi64(x->v[i], x->v[i]);
+    y19[i] = times19(y->v[i]);
+  }
+
+  for(i=0;i<10;i++)
+    for(j=0;j<10;j++)
+    {
+      a = (i & j & 1) ? x2[i] : x->v[i];
+      b = (i+j >= 10) ? y19[j] : y->v[j];
+      h[(i+j)%10] = _mm256_add_epi64(h[(i+j)%10], _mm256_mul_epu32(a, b));
+    }
+
+  carry(h);
+  for(i=0;i<10;i++)
+    r->v[i] = h[i];
+}
+
+/* Same as fe25519x4_mul(r, x, x), computing each cross product only once */
+void fe25519x4_square(fe25519x4 *r, const fe25519x4 *x)
+{
+  __m256i h[10], x2[10], x4[10], x19[10];
+  __m256i a, b;
+  int i,j;
+
+  for(i=0;i<10;i++)
+  {
+    h[i] = _mm256_setzero_si256();
+    x2[i] = _mm256_slli_epi64(x->v[i], 1);
+    x4[i] = _mm256_slli_epi64(x->v[i], 2);
+    x19[i] = times19(x->v[i]);
+  }
+
+  for(i=0;i<10;i++)
+    for(j=i;j<10;j++)
+    {
+      if(i == j)
+        a = (i & 1) ? x2[i] : x->v[i];
+      else
+        a = (i & j & 1) ? x4[i] : x2[i];
+      b = (i+j >= 10) ? x19[j] : x->v[j];
+      h[(i+j)%10] = _mm256_add_epi64(h[(i+j)%10], _mm256_mul_epu32(a, b));
+    }
+
+  carry(h);
+  for(i=0;i<10;i++)
+    r->v[i] = h[i];
+}
+#endif
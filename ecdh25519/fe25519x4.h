@@ -0,0 +1,33 @@
+#ifndef FE25519X4_H
+#define FE25519X4_H
+
+#include <stdint.h>
+#include <immintrin.h>
+#include "fe25519.h"
+
+/* Four independent elements of GF(2^255-19) in radix 2^25.5: limb i of
+ * element k sits in 64-bit lane k of v[i]. Even limbs hold 26 bits, odd
+ * limbs 25 bits. All functions below return limbs below 2^26 (even) and
+ * 2^25 + 2^16 (odd), which is what fe25519x4_mul expects as input. */
+typedef struct
+{
+  __m256i v[10];
+}
+fe25519x4;
+
+void fe25519x4_interleave(fe25519x4 *r, const fe25519 x[4]);
+void fe25519x4_deinterleave(fe25519 r[4], const fe25519x4 *x);
+
+void fe25519x4_cmov(fe25519x4 *r, const fe25519x4 *x, __m256i mask);
+
+void fe25519x4_add(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y);
+
+void fe25519x4_sub(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y);
+
+void fe25519x4_neg(fe25519x4 *r, const fe25519x4 *x);
+
+void fe25519x4_mul(fe25519x4 *r, const fe25519x4 *x, const fe25519x4 *y);
+
+void fe25519x4_square(fe25519x4 *r, const fe25519x4 *x);
+
+#endif
@@ -0,0 +1,136 @@
+#if defined(__AVX2__)
+#include "groupx4.h"
+
+/* 4-way version of the point arithmetic in group.c; the formulas are
+ * identical, only the field arithmetic works on four lanes at once. */
+
+/* 2*d in radix 2^25.5 */
+static const uint64_t ge25519_ec2d[10] = {0x2b2f159, 0x1a6e509, 0x22add7a, 0xd4141d, 0x38052,
+                                          0xf3d130, 0x3407977, 0x19ce331, 0x1c56dff, 0x901b67};
+
+#define ge25519x4_p3 group_gex4
+
+typedef struct
+{
+  fe25519x4 x;
+  fe25519x4 z;
+  fe25519x4 y;
+  fe25519x4 t;
+} ge25519x4_p1p1;
+
+typedef struct
+{
+  fe25519x4 x;
+  fe25519x4 y;
+  fe25519x4 z;
+} ge25519x4_p2;
+
+
+static void p1p1_to_p2(ge25519x4_p2 *r, const ge25519x4_p1p1 *p)
+{
+  fe25519x4_mul(&r->x, &p->x, &p->t);
+  fe25519x4_mul(&r->y, &p->y, &p->z);
+  fe25519x4_mul(&r->z, &p->z, &p->t);
+}
+
+static void p1p1_to_p3(ge25519x4_p3 *r, const ge25519x4_p1p1 *p)
+{
+  p1p1_to_p2((ge25519x4_p2 *)r, p);
+  fe25519x4_mul(&r->t, &p->x, &p->y);
+}
+
+static void add_p1p1(ge25519x4_p1p1 *r, const ge25519x4_p3 *p, const ge25519x4_p3 *q)
+{
+  fe25519x4 a, b, c, d, t, ec2d;
+  int i;
+
+  for(i=0;i<10;i++)
+    ec2d.v[i] = _mm256_set1_epi64x(ge25519_ec2d[i]);
+
+  fe25519x4_sub(&a, &p->y, &p->x); /* A = (Y1-X1)*(Y2-X2) */
+  fe25519x4_sub(&t, &q->y, &q->x);
+  fe25519x4_mul(&a, &a, &t);
+  fe25519x4_add(&b, &p->x, &p->y); /* B = (Y1+X1)*(Y2+X2) */
+  fe25519x4_add(&t, &q->x, &q->y);
+  fe25519x4_mul(&b, &b, &t);
+  fe25519x4_mul(&c, &p->t, &q->t); /* C = T1*k*T2 */
+  fe25519x4_mul(&c, &c, &ec2d);
+  fe25519x4_mul(&d, &p->z, &q->z); /* D = Z1*2*Z2 */
+  fe25519x4_add(&d, &d, &d);
+  fe25519x4_sub(&r->x, &b, &a); /* E = B-A */
+  fe25519x4_sub(&r->t, &d, &c); /* F = D-C */
+  fe25519x4_add(&r->z, &d, &c); /* G = D+C */
+  fe25519x4_add(&r->y, &b, &a); /* H = B+A */
+}
+
+/* See http://www.hyperelliptic.org/EFD/g1p/auto-twisted-extended-1.html#doubling-dbl-2008-hwcd */
+static void dbl_p1p1(ge25519x4_p1p1 *r, const ge25519x4_p2 *p)
+{
+  fe25519x4 a,b,c,d;
+  fe25519x4_square(&a, &p->x);
+  fe25519x4_square(&b, &p->y);
+  fe25519x4_square(&c, &p->z);
+  fe25519x4_add(&c, &c, &c);
+  fe25519x4_neg(&d, &a);
+
+  fe25519x4_add(&r->x, &p->x, &p->y);
+  fe25519x4_square(&r->x, &r->x);
+  fe25519x4_sub(&r->x, &r->x, &a);
+  fe25519x4_sub(&r->x, &r->x, &b);
+  fe25519x4_add(&r->z, &d, &b);
+  fe25519x4_sub(&r->t, &r->z, &c);
+  fe25519x4_sub(&r->y, &d, &b);
+}
+
+void group_gex4_interleave(group_gex4 *r, const group_ge x[4])
+{
+  fe25519 t[4];
+  int i;
+
+  for(i=0;i<4;i++) t[i] = x[i].x;
+  fe25519x4_interleave(&r->x, t);
+  for(i=0;i<4;i++) t[i] = x[i].y;
+  fe25519x4_interleave(&r->y, t);
+  for(i=0;i<4;i++) t[i] = x[i].z;
+  fe25519x4_interleave(&r->z, t);
+  for(i=0;i<4;i++) t[i] = x[i].t;
+  fe25519x4_interleave(&r->t, t);
+}
+
+void group_gex4_deinterleave(group_ge r[4], const group_gex4 *x)
+{
+  fe25519 t[4];
+  int i;
+
+  fe25519x4_deinterleave(t, &x->x);
+  for(i=0;i<4;i++) r[i].x = t[i];
+  fe25519x4_deinterleave(t, &x->y);
+  for(i=0;i<4;i++) r[i].y = t[i];
+  fe25519x4_deinterleave(t, &x->z);
+  for(i=0;i<4;i++) r[i].z = t[i];
+  fe25519x4_deinterleave(t, &x->t);
+  for(i=0;i<4;i++) r[i].t = t[i];
+}
+
+void group_gex4_cmov(group_gex4 *r, const group_gex4 *x, __m256i mask)
+{
+  fe25519x4_cmov(&r->x, &x->x, mask);
+  fe25519x4_cmov(&r->y, &x->y, mask);
+  fe25519x4_cmov(&r->z, &x->z, mask);
+  fe25519x4_cmov(&r->t, &x->t, mask);
+}
+
+void group_gex4_add(group_gex4 *r, const group_gex4 *x, const group_gex4 *y)
+{
+  ge25519x4_p1p1 t;
+  add_p1p1(&t, x, y);
+  p1p1_to_p3(r,&t);
+}
+
+void group_gex4_double(group_gex4 *r, const group_gex4 *x)
+{
+  ge25519x4_p1p1 t;
+  dbl_p1p1(&t, (ge25519x4_p2 *)x);
+  p1p1_to_p3(r,&t);
+}
+#endif
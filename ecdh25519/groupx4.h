@@ -0,0 +1,24 @@
+#ifndef GROUPX4_H
+#define GROUPX4_H
+
+#include "group.h"
+#include "fe25519x4.h"
+
+/* Four group elements in extended coordinates, processed in lockstep */
+typedef struct
+{
+	fe25519x4 x;
+	fe25519x4 y;
+	fe25519x4 z;
+	fe25519x4 t;
+} group_gex4;
+
+void group_gex4_interleave(group_gex4 *r, const group_ge x[4]);
+void group_gex4_deinterleave(group_ge r[4], const group_gex4 *x);
+
+void group_gex4_cmov(group_gex4 *r, const group_gex4 *x, __m256i mask);
+
+void group_gex4_add(group_gex4 *r, const group_gex4 *x, const group_gex4 *y);
+void group_gex4_double(group_gex4 *r, const group_gex4 *x);
+
+#endif
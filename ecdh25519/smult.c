@@ -43,3 +43,56 @@ int crypto_scalarmult_base(unsigned char *pk, const unsigned char *sk)
 }
 
 
+
+#if defined(__AVX2__)
+#include "groupx4.h"
+
+int crypto_scalarmult_x4(unsigned char *ss, const unsigned char *sk, const unsigned char *pk)
+{
+  group_ge p[4];
+  group_gex4 px4, k, s;
+  unsigned char t[4][32];
+  int i,j=5,l,ret=0;
+
+  for(l=0;l<4;l++) {
+    for(i=0;i<32;i++) {
+      t[l][i] = sk[32*l+i];
+    }
+
+    t[l][0] &= 248;
+    t[l][31] &= 127;
+    t[l][31] |= 64;
+
+    /* A rejected lane runs on the base point so the others still finish */
+    if(group_ge_unpack(&p[l], pk+32*l)) {
+      ret |= 1 << l;
+      p[l] = group_ge_base;
+    }
+  }
+
+  group_gex4_interleave(&px4, p);
+
+  /* Scalars differ per lane, so every lane computes k+p and keeps it
+   * only where its bit is set */
+  k = px4;
+  for(i=31;i>=0;i--)
+  {
+    for(;j>=0;j--)
+    {
+      group_gex4_double(&k, &k);
+      group_gex4_add(&s, &k, &px4);
+      group_gex4_cmov(&k, &s, _mm256_set_epi64x(-(int64_t)((t[3][i] >> j) & 1),
+                                                -(int64_t)((t[2][i] >> j) & 1),
+                                                -(int64_t)((t[1][i] >> j) & 1),
+                                                -(int64_t)((t[0][i] >> j) & 1)));
+    }
+    j = 7;
+  }
+
+  group_gex4_deinterleave(p, &k);
+  for(l=0;l<4;l++)
+    if(!((ret >> l) & 1))
+      group_ge_pack(ss+32*l, &p[l]);
+  return ret;
+}
+#endif
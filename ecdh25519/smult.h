@@ -5,4 +5,12 @@ int crypto_scalarmult(unsigned char *ss, const unsigned char *sk, const unsigned
 
 int crypto_scalarmult_base(unsigned char *pk, const unsigned char *sk);
 
+#if defined(__AVX2__)
+/* Four independent scalar multiplications in lockstep (host only);
+ * ss, sk and pk each hold four consecutive 32-byte values.
+ * Returns a mask with bit l set if public key l was rejected, 0 if all
+ * four were accepted. ss is left unwritten for rejected lanes only. */
+int crypto_scalarmult_x4(unsigned char *ss, const unsigned char *sk, const unsigned char *pk);
+#endif
+
 #endif
@@ -68,6 +68,236 @@ static int run_tests(void)
   return 0;
 }
 
+#if defined(__AVX2__)
+static int run_tests_x4(void)
+{
+  int i;
+  unsigned char sk[4*32], pk[4*32], ss[4*32], cmp[32];
+
+  hal_send_str("\n=== Test 2: 4-way ECDH25519 ===\n");
+
+  /* Lanes 0/1 reproduce the test vector, lanes 2/3 swap in other scalars */
+  memcpy(sk+0*32, sk0, 32);
+  memcpy(sk+1*32, sk1, 32);
+  memcpy(sk+2*32, sk1, 32);
+  memcpy(sk+3*32, sk0, 32);
+  memcpy(pk+0*32, cmppk1, 32);
+  memcpy(pk+1*32, cmppk0, 32);
+  memcpy(pk+2*32, cmppk1, 32);
+  memcpy(pk+3*32, cmppk0, 32);
+  sk[3*32] ^= 0x10;
+
+  if(crypto_scalarmult_x4(ss, sk, pk))
+  {
+    hal_send_str("4-way ECDH25519 failed: public key rejected\n");
+    return 1;
+  }
+
+  for(i=0;i<4;i++)
+  {
+    crypto_scalarmult(cmp, sk+32*i, pk+32*i);
+    if(memcmp(ss+32*i, cmp, 32))
+    {
+      hal_send_str("4-way ECDH25519 failed: mismatch with crypto_scalarmult\n");
+      return 1;
+    }
+  }
+  if(memcmp(ss, cmpss, 32) || memcmp(ss+32, cmpss, 32))
+  {
+    hal_send_str("4-way ECDH25519 failed: shared secret mismatch\n");
+    return 1;
+  }
+
+  /* s = 1 is negative and so not a valid encoding: only lane 2 fails,
+   * its ss stays untouched and the other lanes are unchanged */
+  memset(pk+2*32, 0, 32);
+  pk[2*32] = 1;
+  memcpy(cmp, ss, 32);
+  memset(ss+2*32, 0xa5, 32);
+  if(crypto_scalarmult_x4(ss, sk, pk) != (1 << 2))
+  {
+    hal_send_str("4-way ECDH25519 failed: wrong rejection mask\n");
+    return 1;
+  }
+  for(i=0;i<32;i++)
+  {
+    if(ss[2*32+i] != 0xa5)
+    {
+      hal_send_str("4-way ECDH25519 failed: rejected lane written\n");
+      return 1;
+    }
+  }
+  if(memcmp(ss, cmp, 32))
+  {
+    hal_send_str("4-way ECDH25519 failed: valid lane changed by rejected lane\n");
+    return 1;
+  }
+
+  hal_send_str("✓ 4-way ECDH25519 test PASSED\n");
+  return 0;
+}
+#endif
+
+#ifdef BENCH_PRIMITIVES
+/* Number of timed calls per function; the median is reported. Inversion-like
+ * functions cost a few hundred multiplications, so they get fewer runs. */
+#define NRUNS_FAST 101
+#define NRUNS_SLOW 11
+
+static volatile int bench_sink;
+
+static uint64_t median(uint64_t *t, size_t n)
+{
+  size_t i, j;
+  uint64_t x;
+
+  for(i=1;i<n;i++)
+  {
+    x = t[i];
+    for(j=i; j>0 && t[j-1] > x; j--)
+      t[j] = t[j-1];
+    t[j] = x;
+  }
+  return t[n/2];
+}
+
+static uint64_t print_median(const char *name, uint64_t *t, size_t n)
+{
+  char outstr[128];
+  uint64_t m = median(t, n);
+
+#ifdef MPS2_AN386
+  sprintf(outstr, "%-22s [cycle counts not meaningful in qemu emulation]", name);
+#else
+  sprintf(outstr, "%-22s %llu", name, (unsigned long long)m);
+#endif
+  hal_send_str(outstr);
+  return m;
+}
+
+#define BENCH(NAME, N, CALL) \
+  do { \
+    for(r=0;r<(N);r++) \
+    { \
+      t0 = hal_get_time(); \
+      CALL; \
+      t[r] = hal_get_time() - t0; \
+    } \
+    print_median(NAME, t, (N)); \
+  } while(0)
+
+static void run_speed_primitives(void)
+{
+  uint64_t t[NRUNS_FAST], t0;
+  unsigned char b[32], pk[32], ss[32];
+  fe25519 x, y, z;
+  group_ge p, q, s;
+  size_t r;
+
+  hal_send_str("\n=== Primitive Benchmarks (median cycles) ===\n");
+
+  fe25519_unpack(&x, sk0);
+  fe25519_unpack(&y, sk1);
+  group_ge_pack(b, &group_ge_base);
+  group_ge_unpack(&p, cmppk0);
+  group_ge_unpack(&q, cmppk1);
+
+  BENCH("fe25519_freeze", NRUNS_FAST, z = x; fe25519_freeze(&z));
+  BENCH("fe25519_unpack", NRUNS_FAST, fe25519_unpack(&z, sk0));
+  BENCH("fe25519_pack", NRUNS_FAST, fe25519_pack(b, &x));
+  BENCH("fe25519_iszero", NRUNS_FAST, bench_sink = fe25519_iszero(&x));
+  BENCH("fe25519_isone", NRUNS_FAST, bench_sink = fe25519_isone(&x));
+  BENCH("fe25519_isnegative", NRUNS_FAST, bench_sink = fe25519_isnegative(&x));
+  BENCH("fe25519_iseq", NRUNS_FAST, bench_sink = fe25519_iseq(&x, &y));
+  BENCH("fe25519_cmov", NRUNS_FAST, fe25519_cmov(&z, &x, r & 1));
+  BENCH("fe25519_neg", NRUNS_FAST, fe25519_neg(&z, &x));
+  BENCH("fe25519_add", NRUNS_FAST, fe25519_add(&z, &x, &y));
+  BENCH("fe25519_double", NRUNS_FAST, fe25519_double(&z, &x));
+  BENCH("fe25519_sub", NRUNS_FAST, fe25519_sub(&z, &x, &y));
+  BENCH("fe25519_mul", NRUNS_FAST, fe25519_mul(&z, &x, &y));
+  BENCH("fe25519_square", NRUNS_FAST, fe25519_square(&z, &x));
+  BENCH("fe25519_pow2523", NRUNS_SLOW, fe25519_pow2523(&z, &x));
+  BENCH("fe25519_invsqrt", NRUNS_SLOW, fe25519_invsqrt(&z, &x));
+
+  BENCH("group_ge_unpack", NRUNS_SLOW, bench_sink = group_ge_unpack(&s, cmppk0));
+  BENCH("group_ge_pack", NRUNS_SLOW, group_ge_pack(pk, &p));
+  BENCH("group_ge_add", NRUNS_FAST, group_ge_add(&s, &p, &q));
+  BENCH("group_ge_double", NRUNS_FAST, group_ge_double(&s, &p));
+
+  BENCH("crypto_scalarmult", 3, crypto_scalarmult(ss, sk0, cmppk1));
+}
+
+static void run_stack_primitives(void)
+{
+  unsigned char pk[32];
+  group_ge p;
+  size_t stack_usage;
+  char outstr[128];
+
+  hal_send_str("\n=== Primitive Stack Usage ===\n");
+
+  hal_spraystack();
+  bench_sink = group_ge_unpack(&p, cmppk0);
+  stack_usage = hal_checkstack();
+  sprintf(outstr, "stack usage for group_ge_unpack: %zu bytes", stack_usage);
+  hal_send_str(outstr);
+
+  hal_spraystack();
+  group_ge_pack(pk, &p);
+  stack_usage = hal_checkstack();
+  sprintf(outstr, "stack usage for group_ge_pack: %zu bytes", stack_usage);
+  hal_send_str(outstr);
+}
+
+/* Field operations per group operation, counted from group.c; "A" covers
+ * fe25519_add, fe25519_sub, fe25519_neg and fe25519_double. */
+typedef struct
+{
+  unsigned int m, s, a;
+} opcount;
+
+static const opcount ops_unpack = {26, 258, 6};  /* invsqrt: 17M + 254S */
+static const opcount ops_pack   = {30, 255, 5};
+static const opcount ops_add    = { 9,   0, 9};
+static const opcount ops_double = { 4,   4, 8};
+
+static void print_opcount_line(const char *name, unsigned int n, const opcount *o)
+{
+  char outstr[128];
+  sprintf(outstr, "%-18s %4u x %3uM %3uS %3uA", name, n, o->m, o->s, o->a);
+  hal_send_str(outstr);
+}
+
+/* crypto_scalarmult is unpack, 254 doublings, one addition per set bit
+ * of the clamped scalar (bits 253..0) and a final pack */
+static void print_opcount(const unsigned char *sk)
+{
+  unsigned char e[32];
+  unsigned int i, w = 0;
+  opcount total;
+  char outstr[128];
+
+  memcpy(e, sk, 32);
+  e[0] &= 248;
+  e[31] &= 127;
+  e[31] |= 64;
+  for(i=0;i<254;i++)
+    w += (e[i/8] >> (i%8)) & 1;
+
+  total.m = ops_unpack.m + 254*ops_double.m + w*ops_add.m + ops_pack.m;
+  total.s = ops_unpack.s + 254*ops_double.s + w*ops_add.s + ops_pack.s;
+  total.a = ops_unpack.a + 254*ops_double.a + w*ops_add.a + ops_pack.a;
+
+  hal_send_str("\n=== Field Operations per crypto_scalarmult ===\n");
+  print_opcount_line("group_ge_unpack", 1, &ops_unpack);
+  print_opcount_line("group_ge_double", 254, &ops_double);
+  print_opcount_line("group_ge_add", w, &ops_add);
+  print_opcount_line("group_ge_pack", 1, &ops_pack);
+  sprintf(outstr, "total: %u mul, %u square, %u add/sub", total.m, total.s, total.a);
+  hal_send_str(outstr);
+}
+#endif
+
 static void run_speed(void)
 {
   unsigned char pk[32], ss[32];
@@ -84,7 +314,7 @@ static void run_speed(void)
   (void)cycles;
   sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-  sprintf(cycles_str, "%llu\n", cycles);
+  sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
   hal_send_str(cycles_str);
 
@@ -96,10 +326,29 @@ static void run_speed(void)
   (void)cycles;
   sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-  sprintf(cycles_str, "%llu\n", cycles);
+  sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
   hal_send_str(cycles_str);
 
+#if defined(__AVX2__)
+  {
+    unsigned char sk4[4*32], pk4[4*32], ss4[4*32];
+    int i;
+
+    for(i=0;i<4;i++)
+    {
+      memcpy(sk4+32*i, sk0, 32);
+      memcpy(pk4+32*i, pk, 32);
+    }
+    cycles = hal_get_time();
+    crypto_scalarmult_x4(ss4, sk4, pk4);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for crypto_scalarmult_x4 (4 scalar multiplications): ");
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+    hal_send_str(cycles_str);
+  }
+#endif
+
   hal_send_str("Benchmarks completed!\n");
 }
 
@@ -136,9 +385,17 @@ int main(void)
 
   // First test: verify ECDH25519 test vector
   int test_result = run_tests();
+#if defined(__AVX2__)
+  test_result |= run_tests_x4();
+#endif
 
   run_speed();
   run_stack();
+#ifdef BENCH_PRIMITIVES
+  run_speed_primitives();
+  run_stack_primitives();
+  print_opcount(sk0);
+#endif
 
   if(test_result != 0) {
     hal_send_str("\n*** TEST FAILED ***\n");
@@ -3,6 +3,133 @@
 #include "ntt.h"
 #include "reduce.h"
 
+#if defined(__ARM_FEATURE_DSP)
+/* Zetas in the order in which ntt_m4 consumes them: zetas[1..7] for layers
+ * 1-3, then for each block b of 32 coefficients zetas[8+b],
+ * zetas[16+2b..17+2b] and zetas[32+4b..35+4b] for layers 4-6, then for each
+ * group g of 8 coefficients zetas[64+2g..65+2g] and zetas[128+4g..131+4g]
+ * for layers 7-8 */
+static const int32_t zetas_ntt_m4[255] = {
+     25847, -2608894,  -518909,   237124,  -777960,  -876248,   466468,
+   1826347,  2725464,  1024112,  2706023,    95776,  3077325,  3530437,
+   2353451, -1079900,  3585928, -1661693, -3592148, -2537516,  3915439,
+   -359251,  -549488, -1119584, -3861115, -3043716,  3574422, -2867647,
+  -2091905,  2619752, -2108549,  3539968,  -300467,  2348700,  -539299,
+   3119733, -2118186, -3859737, -1699267, -1643818,  3505694, -3821735,
+  -2884855, -1399561, -3277672,  3507263, -2140649, -1600420,  3699596,
+   3111497,  1757237,   -19422,   811944,   531354,   954230,  3881043,
+   2680103,  4010497,   280005,  3900724, -2556880,  2071892, -2797779,
+  -3930395, -1528703,  2091667,  3407706,  2316500,  3817976,
+  -3677745, -3041255, -3342478,  2244091, -2446433, -3562462,
+  -1452451,  3475950,   266997,  2434439, -1235728,  3513181,
+   2176455, -1585221, -3520352, -3759364, -1197226, -3193378,
+  -1257611,  1939314,   900702,  1859098,   909542,   819034,
+  -4083598, -1000202,   495491, -1613174,   -43260,  -522500,
+  -3190144, -3157330,  -655327, -3122442,  2031748,  3207046,
+  -3632928,   126922, -3556995,  -525098,  -768622, -3595838,
+   3412210,  -983419,   342297,   286988, -2437823,  4108315,
+   2147896,  2715295,  3437287, -3342277,  1735879,   203044,
+  -2967645, -3693493,  2842341,  2691481, -2590150,  1265009,
+   -411027, -2477047,  4055324,  1247620,  2486353,  1595974,
+   -671102, -1228525, -3767016,  1250494,  2635921, -3548272,
+    -22981, -1308169, -2994039,  1869119,  1903435, -1050970,
+   -381987,  1349076, -1333058,  1237275, -3318210, -1430225,
+   1852771, -1430430,  -451100,  1312455,  3306115, -1962642,
+  -3343383,   264944, -1279661,  1917081, -2546312, -1374803,
+    508951,  3097992,  1500165,   777191,  2235880,  3406031,
+     44288, -1100098,  -542412, -2831860, -1671176, -1846953,
+    904516,  3958618, -2584293, -3724270,   594136, -3776993,
+  -3724342,    -8578, -2013608,  2432395,  2454455,  -164721,
+   1653064, -3249728,  1957272,  3369112,   185531, -1207385,
+   2389356,  -210977, -3183426,   162844,  1616392,  3014001,
+    759969, -1316856,   810149,  1652634, -3694233, -1799107,
+    189548, -3553272, -3038916,  3523897,  3866901,   269760,
+   3159746, -1851402,  2213111,  -975884,  1717735,   472078,
+  -2409325,  -177440,  -426683,  1723600, -1803090,  1910376,
+   1315589,  1341330, -1667432, -1104333,  -260646, -3833893,
+   1285669, -1584928, -2939036, -2235985,  -420899, -2286327,
+   -812732, -1439742,   183443,  -976891,  1612842, -3545687,
+  -3019102, -3881060,  -554416,  3919660,   -48306, -1362209,
+  -3628969,  3839961,  3937738,  1400424,  -846154,  1976782
+};
+
+/* Negated zetas in the order in which invntt_tomont_m4 consumes them: for
+ * each group g of 8 coefficients zetas[255-4g..252-4g] and
+ * zetas[127-2g..126-2g] for layers 1-2, for each block b of 32 coefficients
+ * zetas[63-4b..60-4b], zetas[31-2b..30-2b] and zetas[15-b] for layers 3-5,
+ * then zetas[7..1] for layers 6-8 followed by f = mont^2/256 */
+static const int32_t zetas_invntt_m4[256] = {
+  -1976782,   846154, -1400424, -3937738, -3839961,  3628969,
+   1362209,    48306, -3919660,   554416,  3881060,  3019102,
+   3545687, -1612842,   976891,  -183443,  1439742,   812732,
+   2286327,   420899,  2235985,  2939036,  1584928, -1285669,
+   3833893,   260646,  1104333,  1667432, -1341330, -1315589,
+  -1910376,  1803090, -1723600,   426683,   177440,  2409325,
+   -472078, -1717735,   975884, -2213111,  1851402, -3159746,
+   -269760, -3866901, -3523897,  3038916,  3553272,  -189548,
+   1799107,  3694233, -1652634,  -810149,  1316856,  -759969,
+  -3014001, -1616392,  -162844,  3183426,   210977, -2389356,
+   1207385,  -185531, -3369112, -1957272,  3249728, -1653064,
+    164721, -2454455, -2432395,  2013608,     8578,  3724342,
+   3776993,  -594136,  3724270,  2584293, -3958618,  -904516,
+   1846953,  1671176,  2831860,   542412,  1100098,   -44288,
+  -3406031, -2235880,  -777191, -1500165, -3097992,  -508951,
+   1374803,  2546312, -1917081,  1279661,  -264944,  3343383,
+   1962642, -3306115, -1312455,   451100,  1430430, -1852771,
+   1430225,  3318210, -1237275,  1333058, -1349076,   381987,
+   1050970, -1903435, -1869119,  2994039,  1308169,    22981,
+   3548272, -2635921, -1250494,  3767016,  1228525,   671102,
+  -1595974, -2486353, -1247620, -4055324,  2477047,   411027,
+  -1265009,  2590150, -2691481, -2842341,  3693493,  2967645,
+   -203044, -1735879,  3342277, -3437287, -2715295, -2147896,
+  -4108315,  2437823,  -286988,  -342297,   983419, -3412210,
+   3595838,   768622,   525098,  3556995,  -126922,  3632928,
+  -3207046, -2031748,  3122442,   655327,  3157330,  3190144,
+    522500,    43260,  1613174,  -495491,  1000202,  4083598,
+   -819034,  -909542, -1859098,  -900702, -1939314,  1257611,
+   3193378,  1197226,  3759364,  3520352,  1585221, -2176455,
+  -3513181,  1235728, -2434439,  -266997, -3475950,  1452451,
+   3562462,  2446433, -2244091,  3342478,  3041255,  3677745,
+  -3817976, -2316500, -3407706, -2091667,  1528703,  3930395,
+   2797779, -2071892,  2556880, -3900724,  -280005, -4010497, -2680103,
+  -3881043,  -954230,  -531354,  -811944,    19422, -1757237, -3111497,
+  -3699596,  1600420,  2140649, -3507263,  3277672,  1399561,  2884855,
+   3821735, -3505694,  1643818,  1699267,  3859737,  2118186, -3119733,
+    539299, -2348700,   300467, -3539968,  2108549, -2619752,  2091905,
+   2867647, -3574422,  3043716,  3861115,  1119584,   549488,   359251,
+  -3915439,  2537516,  3592148,  1661693, -3585928,  1079900, -2353451,
+  -3530437, -3077325,   -95776, -2706023, -1024112, -2725464, -1826347,
+   -466468,   876248,   777960,  -237124,   518909,  2608894,   -25847,    41978
+};
+
+/*************************************************
+* Name:        ntt
+*
+* Description: Forward NTT, in-place. No modular reduction is performed after
+*              additions or subtractions. Output vector is in bitreversed order.
+*              Cortex-M4 implementation in ntt_m4.S
+*
+* Arguments:   - uint32_t p[N]: input/output coefficient array
+**************************************************/
+void ntt(int32_t a[N]) {
+  ntt_m4(a, zetas_ntt_m4);
+}
+
+/*************************************************
+* Name:        invntt_tomont
+*
+* Description: Inverse NTT and multiplication by Montgomery factor 2^32.
+*              In-place. No modular reductions after additions or
+*              subtractions; input coefficients need to be smaller than
+*              Q in absolute value. Output coefficient are smaller than Q in
+*              absolute value. Cortex-M4 implementation in ntt_m4.S
+*
+* Arguments:   - uint32_t p[N]: input/output coefficient array
+**************************************************/
+void invntt_tomont(int32_t a[N]) {
+  invntt_tomont_m4(a, zetas_invntt_m4);
+}
+#else
 static const int32_t zetas[N] = {
          0,    25847, -2608894,  -518909,   237124,  -777960,  -876248,   466468,
    1826347,  2353451,  -359251, -2091905,  3119733, -2884855,  3111497,  2680103,
@@ -96,3 +223,4 @@ void invntt_tomont(int32_t a[N]) {
     a[j] = montgomery_reduce((int64_t)f * a[j]);
   }
 }
+#endif
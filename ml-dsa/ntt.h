@@ -10,4 +10,12 @@ void ntt(int32_t a[N]);
 #define invntt_tomont DILITHIUM_NAMESPACE(invntt_tomont)
 void invntt_tomont(int32_t a[N]);
 
+#if defined(__ARM_FEATURE_DSP)
+#define ntt_m4 DILITHIUM_NAMESPACE(ntt_m4)
+void ntt_m4(int32_t a[N], const int32_t zetas[255]);
+
+#define invntt_tomont_m4 DILITHIUM_NAMESPACE(invntt_tomont_m4)
+void invntt_tomont_m4(int32_t a[N], const int32_t zetas[256]);
+#endif
+
 #endif
@@ -143,6 +143,37 @@ void unpack_sk(uint8_t rho[SEEDBYTES],
     polyt0_unpack(&t0->vec[i], sk + i*POLYT0_PACKEDBYTES);
 }
 
+/*************************************************
+* Name:        unpack_sk_seeds
+*
+* Description: Unpack only rho, tr and key from the secret key; the
+*              vectors are read in bit-packed form at SK_S1_OFFSET,
+*              SK_S2_OFFSET and SK_T0_OFFSET.
+*
+* Arguments:   - const uint8_t rho[]: output byte array for rho
+*              - const uint8_t tr[]: output byte array for tr
+*              - const uint8_t key[]: output byte array for key
+*              - uint8_t sk[]: byte array containing bit-packed sk
+**************************************************/
+void unpack_sk_seeds(uint8_t rho[SEEDBYTES],
+                     uint8_t tr[TRBYTES],
+                     uint8_t key[SEEDBYTES],
+                     const uint8_t sk[CRYPTO_SECRETKEYBYTES])
+{
+  unsigned int i;
+
+  for(i = 0; i < SEEDBYTES; ++i)
+    rho[i] = sk[i];
+  sk += SEEDBYTES;
+
+  for(i = 0; i < SEEDBYTES; ++i)
+    key[i] = sk[i];
+  sk += SEEDBYTES;
+
+  for(i = 0; i < TRBYTES; ++i)
+    tr[i] = sk[i];
+}
+
 /*************************************************
 * Name:        pack_sig
 *
@@ -5,6 +5,11 @@
 #include "params.h"
 #include "polyvec.h"
 
+/* Offsets of the bit-packed vectors in sk = (rho, key, tr, s1, s2, t0) */
+#define SK_S1_OFFSET (2*SEEDBYTES + TRBYTES)
+#define SK_S2_OFFSET (SK_S1_OFFSET + L*POLYETA_PACKEDBYTES)
+#define SK_T0_OFFSET (SK_S2_OFFSET + K*POLYETA_PACKEDBYTES)
+
 #define pack_pk DILITHIUM_NAMESPACE(pack_pk)
 void pack_pk(uint8_t pk[CRYPTO_PUBLICKEYBYTES], const uint8_t rho[SEEDBYTES], const polyveck *t1);
 
@@ -32,6 +37,12 @@ void unpack_sk(uint8_t rho[SEEDBYTES],
                polyveck *s2,
                const uint8_t sk[CRYPTO_SECRETKEYBYTES]);
 
+#define unpack_sk_seeds DILITHIUM_NAMESPACE(unpack_sk_seeds)
+void unpack_sk_seeds(uint8_t rho[SEEDBYTES],
+                     uint8_t tr[TRBYTES],
+                     uint8_t key[SEEDBYTES],
+                     const uint8_t sk[CRYPTO_SECRETKEYBYTES]);
+
 #define unpack_sig DILITHIUM_NAMESPACE(unpack_sig)
 int unpack_sig(uint8_t c[CTILDEBYTES], polyvecl *z, polyveck *h, const uint8_t sig[CRYPTO_BYTES]);
 
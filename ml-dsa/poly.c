@@ -520,6 +520,128 @@ void poly_challenge(poly *c, const uint8_t seed[CTILDEBYTES]) {
   }
 }
 
+/*************************************************
+* Name:        poly_sparse
+*
+* Description: Records the positions and signs of the nonzero coefficients
+*              of a challenge polynomial for poly_sparse_mul. Runs over all
+*              coefficients without branching on them, but the entry that
+*              is written depends on how many nonzero coefficients precede
+*              the current one, so the store addresses depend on c.
+*
+* Arguments:   - sparsepoly *s: pointer to output sparse polynomial
+*              - const poly *c: pointer to challenge polynomial
+**************************************************/
+void poly_sparse(sparsepoly *s, const poly *c) {
+  unsigned int i, j;
+
+  j = 0;
+  for(i = 0; i < N; ++i) {
+    s->pos[j] = i;
+    s->sign[j] = c->coeffs[i] >> 31;
+    j += c->coeffs[i] & 1;
+  }
+}
+
+/*************************************************
+* Name:        poly_sparse_mul
+*
+* Description: Multiplication of a polynomial by a challenge polynomial.
+*              Every nonzero coefficient at position p adds the window
+*              starting at N-p of (-a, a), which is a times X^p, with its
+*              sign applied by a mask. The instructions executed do not
+*              depend on the positions or signs, but the addresses read do:
+*              this is only constant time on targets without a data cache,
+*              see DILITHIUM_SPARSE_CHALLENGE in sign.c. No modular
+*              reduction is performed, so input coefficients need to be
+*              smaller than 2^31/TAU in absolute value.
+*
+* Arguments:   - poly *c: pointer to output polynomial (may equal a)
+*              - const sparsepoly *s: pointer to challenge polynomial
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_sparse_mul(poly *c, const sparsepoly *s, const poly *a) {
+  unsigned int i, j;
+  int32_t t[2*N], m;
+  const int32_t *x;
+  DBENCH_START();
+
+  for(j = 0; j < N; ++j) {
+    t[j] = -a->coeffs[j];
+    t[N + j] = a->coeffs[j];
+    c->coeffs[j] = 0;
+  }
+
+  for(i = 0; i < TAU; ++i) {
+    x = &t[N - s->pos[i]];
+    m = s->sign[i];
+    for(j = 0; j < N; ++j)
+      c->coeffs[j] += (x[j] ^ m) - m;
+  }
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        sparse_mul_acc
+*
+* Description: Adds or subtracts the product of a polynomial and a challenge
+*              polynomial without scratch memory: coefficient j of a times
+*              X^p is a[(j-p) mod N], negated if j < p. The signs are
+*              applied by masks, so the instructions executed do not depend
+*              on the positions or signs, but the addresses read depend on
+*              the positions, as in poly_sparse_mul. No modular reduction
+*              is performed.
+*
+* Arguments:   - poly *c: pointer to input/output polynomial
+*              - const sparsepoly *s: pointer to challenge polynomial
+*              - const poly *a: pointer to input polynomial (not equal to c)
+*              - int32_t neg: 0 to add the product, -1 to subtract it
+**************************************************/
+static void sparse_mul_acc(poly *c, const sparsepoly *s, const poly *a, int32_t neg) {
+  unsigned int i, j, k;
+  int32_t m;
+  DBENCH_START();
+
+  for(i = 0; i < TAU; ++i) {
+    for(j = 0; j < N; ++j) {
+      k = j - s->pos[i];
+      m = s->sign[i] ^ neg ^ ((int32_t)k >> 31);
+      c->coeffs[j] += (a->coeffs[k & (N-1)] ^ m) - m;
+    }
+  }
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        poly_sparse_mul_add
+*
+* Description: Add the product of a polynomial and a challenge polynomial,
+*              see sparse_mul_acc.
+*
+* Arguments:   - poly *c: pointer to input/output polynomial
+*              - const sparsepoly *s: pointer to challenge polynomial
+*              - const poly *a: pointer to input polynomial (not equal to c)
+**************************************************/
+void poly_sparse_mul_add(poly *c, const sparsepoly *s, const poly *a) {
+  sparse_mul_acc(c, s, a, 0);
+}
+
+/*************************************************
+* Name:        poly_sparse_mul_sub
+*
+* Description: Subtract the product of a polynomial and a challenge
+*              polynomial, see sparse_mul_acc.
+*
+* Arguments:   - poly *c: pointer to input/output polynomial
+*              - const sparsepoly *s: pointer to challenge polynomial
+*              - const poly *a: pointer to input polynomial (not equal to c)
+**************************************************/
+void poly_sparse_mul_sub(poly *c, const sparsepoly *s, const poly *a) {
+  sparse_mul_acc(c, s, a, -1);
+}
+
 /*************************************************
 * Name:        polyeta_pack
 *
@@ -8,6 +8,13 @@ typedef struct {
   int32_t coeffs[N];
 } poly;
 
+/* Challenge polynomial given by the positions and signs (0 for 1, -1 for -1)
+ * of its TAU nonzero coefficients; the last entry is scratch */
+typedef struct {
+  uint8_t pos[TAU + 1];
+  int32_t sign[TAU + 1];
+} sparsepoly;
+
 #define poly_reduce DILITHIUM_NAMESPACE(poly_reduce)
 void poly_reduce(poly *a);
 #define poly_caddq DILITHIUM_NAMESPACE(poly_caddq)
@@ -52,6 +59,14 @@ void poly_uniform_gamma1(poly *a,
                          uint16_t nonce);
 #define poly_challenge DILITHIUM_NAMESPACE(poly_challenge)
 void poly_challenge(poly *c, const uint8_t seed[CTILDEBYTES]);
+#define poly_sparse DILITHIUM_NAMESPACE(poly_sparse)
+void poly_sparse(sparsepoly *s, const poly *c);
+#define poly_sparse_mul DILITHIUM_NAMESPACE(poly_sparse_mul)
+void poly_sparse_mul(poly *c, const sparsepoly *s, const poly *a);
+#define poly_sparse_mul_add DILITHIUM_NAMESPACE(poly_sparse_mul_add)
+void poly_sparse_mul_add(poly *c, const sparsepoly *s, const poly *a);
+#define poly_sparse_mul_sub DILITHIUM_NAMESPACE(poly_sparse_mul_sub)
+void poly_sparse_mul_sub(poly *c, const sparsepoly *s, const poly *a);
 
 #define polyeta_pack DILITHIUM_NAMESPACE(polyeta_pack)
 void polyeta_pack(uint8_t *r, const poly *a);
@@ -99,6 +99,44 @@ void polyvecl_pointwise_poly_montgomery(polyvecl *r, const poly *a, const polyve
     poly_pointwise_montgomery(&r->vec[i], a, &v->vec[i]);
 }
 
+/*************************************************
+* Name:        polyvecl_sparse_mul_eta
+*
+* Description: Multiply a bit-packed vector of length L with coefficients
+*              in [-ETA,ETA] by a challenge polynomial, unpacking one
+*              polynomial at a time. Output coefficients are exact.
+*
+* Arguments:   - polyvecl *r: pointer to output vector
+*              - const sparsepoly *c: pointer to challenge polynomial
+*              - const uint8_t *s: byte array with L*POLYETA_PACKEDBYTES
+*                                  bytes of bit-packed input vector
+**************************************************/
+void polyvecl_sparse_mul_eta(polyvecl *r, const sparsepoly *c, const uint8_t *s) {
+  unsigned int i;
+
+  for(i = 0; i < L; ++i) {
+    polyeta_unpack(&r->vec[i], s + i*POLYETA_PACKEDBYTES);
+    poly_sparse_mul(&r->vec[i], c, &r->vec[i]);
+  }
+}
+
+/*************************************************
+* Name:        polyvecl_sparse_mul
+*
+* Description: Multiply a vector of length L by a challenge polynomial.
+*              Output coefficients are exact.
+*
+* Arguments:   - polyvecl *r: pointer to output vector
+*              - const sparsepoly *c: pointer to challenge polynomial
+*              - const polyvecl *v: pointer to input vector
+**************************************************/
+void polyvecl_sparse_mul(polyvecl *r, const sparsepoly *c, const polyvecl *v) {
+  unsigned int i;
+
+  for(i = 0; i < L; ++i)
+    poly_sparse_mul(&r->vec[i], c, &v->vec[i]);
+}
+
 /*************************************************
 * Name:        polyvecl_pointwise_acc_montgomery
 *
@@ -275,6 +313,65 @@ void polyveck_pointwise_poly_montgomery(polyveck *r, const poly *a, const polyve
     poly_pointwise_montgomery(&r->vec[i], a, &v->vec[i]);
 }
 
+/*************************************************
+* Name:        polyveck_sparse_mul_eta
+*
+* Description: Multiply a bit-packed vector of length K with coefficients
+*              in [-ETA,ETA] by a challenge polynomial, unpacking one
+*              polynomial at a time. Output coefficients are exact.
+*
+* Arguments:   - polyveck *r: pointer to output vector
+*              - const sparsepoly *c: pointer to challenge polynomial
+*              - const uint8_t *s: byte array with K*POLYETA_PACKEDBYTES
+*                                  bytes of bit-packed input vector
+**************************************************/
+void polyveck_sparse_mul_eta(polyveck *r, const sparsepoly *c, const uint8_t *s) {
+  unsigned int i;
+
+  for(i = 0; i < K; ++i) {
+    polyeta_unpack(&r->vec[i], s + i*POLYETA_PACKEDBYTES);
+    poly_sparse_mul(&r->vec[i], c, &r->vec[i]);
+  }
+}
+
+/*************************************************
+* Name:        polyveck_sparse_mul
+*
+* Description: Multiply a vector of length K by a challenge polynomial.
+*              Output coefficients are exact.
+*
+* Arguments:   - polyveck *r: pointer to output vector
+*              - const sparsepoly *c: pointer to challenge polynomial
+*              - const polyveck *v: pointer to input vector
+**************************************************/
+void polyveck_sparse_mul(polyveck *r, const sparsepoly *c, const polyveck *v) {
+  unsigned int i;
+
+  for(i = 0; i < K; ++i)
+    poly_sparse_mul(&r->vec[i], c, &v->vec[i]);
+}
+
+/*************************************************
+* Name:        polyveck_sparse_mul_t0
+*
+* Description: Multiply the bit-packed vector t0 of length K by a challenge
+*              polynomial, unpacking one polynomial at a time. Output
+*              coefficients are exact.
+*
+* Arguments:   - polyveck *r: pointer to output vector
+*              - const sparsepoly *c: pointer to challenge polynomial
+*              - const uint8_t *t0: byte array with K*POLYT0_PACKEDBYTES
+*                                   bytes of bit-packed input vector
+**************************************************/
+void polyveck_sparse_mul_t0(polyveck *r, const sparsepoly *c, const uint8_t *t0) {
+  unsigned int i;
+
+  for(i = 0; i < K; ++i) {
+    polyt0_unpack(&r->vec[i], t0 + i*POLYT0_PACKEDBYTES);
+    poly_sparse_mul(&r->vec[i], c, &r->vec[i]);
+  }
+}
+
 
 /*************************************************
 * Name:        polyveck_chknorm
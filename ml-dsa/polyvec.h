@@ -28,6 +28,10 @@ void polyvecl_ntt(polyvecl *v);
 void polyvecl_invntt_tomont(polyvecl *v);
 #define polyvecl_pointwise_poly_montgomery DILITHIUM_NAMESPACE(polyvecl_pointwise_poly_montgomery)
 void polyvecl_pointwise_poly_montgomery(polyvecl *r, const poly *a, const polyvecl *v);
+#define polyvecl_sparse_mul_eta DILITHIUM_NAMESPACE(polyvecl_sparse_mul_eta)
+void polyvecl_sparse_mul_eta(polyvecl *r, const sparsepoly *c, const uint8_t *s);
+#define polyvecl_sparse_mul DILITHIUM_NAMESPACE(polyvecl_sparse_mul)
+void polyvecl_sparse_mul(polyvecl *r, const sparsepoly *c, const polyvecl *v);
 #define polyvecl_pointwise_acc_montgomery \
         DILITHIUM_NAMESPACE(polyvecl_pointwise_acc_montgomery)
 void polyvecl_pointwise_acc_montgomery(poly *w,
@@ -66,6 +70,12 @@ void polyveck_ntt(polyveck *v);
 void polyveck_invntt_tomont(polyveck *v);
 #define polyveck_pointwise_poly_montgomery DILITHIUM_NAMESPACE(polyveck_pointwise_poly_montgomery)
 void polyveck_pointwise_poly_montgomery(polyveck *r, const poly *a, const polyveck *v);
+#define polyveck_sparse_mul_eta DILITHIUM_NAMESPACE(polyveck_sparse_mul_eta)
+void polyveck_sparse_mul_eta(polyveck *r, const sparsepoly *c, const uint8_t *s);
+#define polyveck_sparse_mul DILITHIUM_NAMESPACE(polyveck_sparse_mul)
+void polyveck_sparse_mul(polyveck *r, const sparsepoly *c, const polyveck *v);
+#define polyveck_sparse_mul_t0 DILITHIUM_NAMESPACE(polyveck_sparse_mul_t0)
+void polyveck_sparse_mul_t0(polyveck *r, const sparsepoly *c, const uint8_t *t0);
 
 #define polyveck_chknorm DILITHIUM_NAMESPACE(polyveck_chknorm)
 int polyveck_chknorm(const polyveck *v, int32_t B);
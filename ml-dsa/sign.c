@@ -2,12 +2,27 @@
 #include <string.h>
 #include "params.h"
 #include "sign.h"
+#include "sign_prepared.h"
+#include "sign_stream.h"
 #include "packing.h"
 #include "polyvec.h"
 #include "poly.h"
 #include "randombytes.h"
 #include "symmetric.h"
 #include "fips202.h"
+#include "reduce.h"
+
+/* DILITHIUM_SPARSE_CHALLENGE=1 multiplies by the challenge with
+ * poly_sparse_mul instead of pointwise multiplication and the inverse NTT
+ * when signing. This is faster where the NTT is in C and keeps s1, s2 and
+ * t0 bit-packed in sk; with the Cortex-M4 NTT the NTT-based products are
+ * faster. The sparse multiplication reads memory at addresses that depend
+ * on the positions of the challenge, which is secret for rejected
+ * iterations, so it is only constant time on targets without a data cache
+ * and is off unless selected, see the Makefile */
+#ifndef DILITHIUM_SPARSE_CHALLENGE
+#define DILITHIUM_SPARSE_CHALLENGE 0
+#endif
 
 /*************************************************
 * Name:        crypto_sign_keypair_internal
@@ -90,6 +105,366 @@ int crypto_sign_keypair(uint8_t *pk, uint8_t *sk) {
   return crypto_sign_keypair_internal(pk, sk, seed);
 }
 
+/*************************************************
+* Name:        compute_mu
+*
+* Description: Computes mu = CRH(tr, pre, msg)
+*
+* Arguments:   - uint8_t *mu:        pointer to output mu (of length CRHBYTES)
+*              - const uint8_t *tr:  pointer to tr = H(pk) (of length TRBYTES)
+*              - const uint8_t *pre: pointer to prefix string
+*              - size_t prelen:      length of prefix string
+*              - const uint8_t *m:   pointer to message
+*              - size_t mlen:        length of message
+**************************************************/
+static void compute_mu(uint8_t mu[CRHBYTES],
+                       const uint8_t tr[TRBYTES],
+                       const uint8_t *pre,
+                       size_t prelen,
+                       const uint8_t *m,
+                       size_t mlen)
+{
+  keccak_state state;
+
+  shake256_init(&state);
+  shake256_absorb(&state, tr, TRBYTES);
+  shake256_absorb(&state, pre, prelen);
+  shake256_absorb(&state, m, mlen);
+  shake256_finalize(&state);
+  shake256_squeeze(mu, CRHBYTES, &state);
+}
+
+#ifndef DILITHIUM_LOWSTACK
+#if DILITHIUM_SPARSE_CHALLENGE
+/*************************************************
+* Name:        crypto_sign_signature_extmu_internal
+*
+* Description: Computes signature from mu = CRH(tr, pre, msg) (external mu,
+*              FIPS 204). Internal API.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *mu:    pointer to mu = CRH(tr, pre, msg) (of length CRHBYTES)
+*              - uint8_t *rnd:   pointer to random seed
+*              - uint8_t *sk:    pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_extmu_internal(uint8_t *sig,
+                                         size_t *siglen,
+                                         const uint8_t mu[CRHBYTES],
+                                         const uint8_t rnd[RNDBYTES],
+                                         const uint8_t *sk)
+{
+  unsigned int n;
+  uint8_t seedbuf[2*SEEDBYTES + TRBYTES + CRHBYTES];
+  uint8_t *rho, *tr, *key, *rhoprime;
+  uint16_t nonce = 0;
+  polyvecl mat[K], y, z;
+  polyveck w1, w0, h;
+  poly cp;
+  sparsepoly c;
+  keccak_state state;
+
+  rho = seedbuf;
+  tr = rho + SEEDBYTES;
+  key = tr + TRBYTES;
+  rhoprime = key + SEEDBYTES;
+  unpack_sk_seeds(rho, tr, key, sk);
+
+  /* Compute rhoprime = CRH(key, rnd, mu) */
+  shake256_init(&state);
+  shake256_absorb(&state, key, SEEDBYTES);
+  shake256_absorb(&state, rnd, RNDBYTES);
+  shake256_absorb(&state, mu, CRHBYTES);
+  shake256_finalize(&state);
+  shake256_squeeze(rhoprime, CRHBYTES, &state);
+
+  /* Expand matrix */
+  polyvec_matrix_expand(mat, rho);
+
+rej:
+  /* Sample intermediate vector y */
+  polyvecl_uniform_gamma1(&y, rhoprime, nonce++);
+
+  /* Matrix-vector multiplication */
+  z = y;
+  polyvecl_ntt(&z);
+  polyvec_matrix_pointwise_montgomery(&w1, mat, &z);
+  polyveck_reduce(&w1);
+  polyveck_invntt_tomont(&w1);
+
+  /* Decompose w and call the random oracle */
+  polyveck_caddq(&w1);
+  polyveck_decompose(&w1, &w0, &w1);
+  polyveck_pack_w1(sig, &w1);
+
+  shake256_init(&state);
+  shake256_absorb(&state, mu, CRHBYTES);
+  shake256_absorb(&state, sig, K*POLYW1_PACKEDBYTES);
+  shake256_finalize(&state);
+  shake256_squeeze(sig, CTILDEBYTES, &state);
+  poly_challenge(&cp, sig);
+  poly_sparse(&c, &cp);
+
+  /* Compute z, reject if it reveals secret */
+  polyvecl_sparse_mul_eta(&z, &c, sk + SK_S1_OFFSET);
+  polyvecl_add(&z, &z, &y);
+  polyvecl_reduce(&z);
+  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+    goto rej;
+
+  /* Check that subtracting cs2 does not change high bits of w and low bits
+   * do not reveal secret information */
+  polyveck_sparse_mul_eta(&h, &c, sk + SK_S2_OFFSET);
+  polyveck_sub(&w0, &w0, &h);
+  polyveck_reduce(&w0);
+  if(polyveck_chknorm(&w0, GAMMA2 - BETA))
+    goto rej;
+
+  /* Compute hints for w1 */
+  polyveck_sparse_mul_t0(&h, &c, sk + SK_T0_OFFSET);
+  polyveck_reduce(&h);
+  if(polyveck_chknorm(&h, GAMMA2))
+    goto rej;
+
+  polyveck_add(&w0, &w0, &h);
+  n = polyveck_make_hint(&h, &w0, &w1);
+  if(n > OMEGA)
+    goto rej;
+
+  /* Write signature */
+  pack_sig(sig, sig, &z, &h);
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+#else
+/*************************************************
+* Name:        crypto_sign_signature_extmu_internal
+*
+* Description: Computes signature from mu = CRH(tr, pre, msg) (external mu,
+*              FIPS 204). Internal API. Expands sk with crypto_sign_prepare
+*              and signs with crypto_sign_signature_prepared_extmu_internal.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *mu:    pointer to mu = CRH(tr, pre, msg) (of length CRHBYTES)
+*              - uint8_t *rnd:   pointer to random seed
+*              - uint8_t *sk:    pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_extmu_internal(uint8_t *sig,
+                                         size_t *siglen,
+                                         const uint8_t mu[CRHBYTES],
+                                         const uint8_t rnd[RNDBYTES],
+                                         const uint8_t *sk)
+{
+  crypto_sign_ctx prep;
+
+  crypto_sign_prepare(&prep, sk);
+  return crypto_sign_signature_prepared_extmu_internal(sig, siglen, mu, rnd, &prep);
+}
+#endif
+#else
+/*
+ * Low-stack signing (make DILITHIUM_LOWSTACK=1): neither the matrix A nor
+ * any vector of polynomials is kept in memory. Row i of w = A*y is computed
+ * by matacc, which samples y one polynomial at a time and multiplies the
+ * entries of A into it while they are sampled; it runs once to hash w1 and,
+ * if z passes its check, once more for the checks on w0 and the hints. s1,
+ * s2 and t0 are unpacked from sk one polynomial at a time, and z and h are
+ * written to sig as soon as they are known. Signatures are identical to the
+ * default implementation.
+ */
+
+/*************************************************
+* Name:        matacc
+*
+* Description: Computes row i of w = A*y in normal domain, where y is the
+*              masking vector of the given nonce. Matrix entries are sampled
+*              as in poly_uniform, but one block at a time, and every
+*              accepted coefficient is multiplied into w right away.
+*
+* Arguments:   - poly *w: pointer to output polynomial
+*              - const uint8_t rho[]: byte array with seed of the matrix
+*              - const uint8_t rhoprime[]: byte array with seed of y
+*              - uint16_t nonce: nonce of y
+*              - unsigned int i: index of the row
+**************************************************/
+static void matacc(poly *w,
+                   const uint8_t rho[SEEDBYTES],
+                   const uint8_t rhoprime[CRHBYTES],
+                   uint16_t nonce,
+                   unsigned int i)
+{
+  unsigned int j, k, pos;
+  uint32_t t;
+  uint8_t buf[STREAM128_BLOCKBYTES];
+  stream128_state state;
+  poly y;
+
+  for(k = 0; k < N; ++k)
+    w->coeffs[k] = 0;
+
+  for(j = 0; j < L; ++j) {
+    poly_uniform_gamma1(&y, rhoprime, L*nonce + j);
+    poly_ntt(&y);
+
+    stream128_init(&state, rho, (i << 8) + j);
+    k = 0;
+    while(k < N) {
+      stream128_squeezeblocks(buf, 1, &state);
+      for(pos = 0; pos < STREAM128_BLOCKBYTES && k < N; pos += 3) {
+        t  = buf[pos];
+        t |= (uint32_t)buf[pos+1] << 8;
+        t |= (uint32_t)buf[pos+2] << 16;
+        t &= 0x7FFFFF;
+
+        if(t < Q) {
+          w->coeffs[k] += montgomery_reduce((int64_t)t * y.coeffs[k]);
+          k++;
+        }
+      }
+    }
+  }
+
+  poly_reduce(w);
+  poly_invntt_tomont(w);
+}
+
+/*************************************************
+* Name:        sign_attempt
+*
+* Description: One iteration of the rejection loop of
+*              crypto_sign_signature_internal
+*
+* Arguments:   - uint8_t *sig: pointer to output signature
+*              - const uint8_t mu[]: byte array with mu
+*              - const uint8_t rhoprime[]: byte array with seed of y
+*              - const uint8_t *sk: pointer to bit-packed secret key
+*              - uint16_t nonce: nonce of y
+*
+* Returns 0 if sig holds the signature, 1 if the attempt was rejected
+**************************************************/
+static int sign_attempt(uint8_t sig[CRYPTO_BYTES],
+                        const uint8_t mu[CRHBYTES],
+                        const uint8_t rhoprime[CRHBYTES],
+                        const uint8_t *sk,
+                        uint16_t nonce)
+{
+  unsigned int i, j, n;
+  uint8_t *hint = sig + CTILDEBYTES + L*POLYZ_PACKEDBYTES;
+  const uint8_t *rho = sk;
+  poly w1, w0, t;
+  sparsepoly c;
+  keccak_state state;
+
+  /* Hash mu and w1 row by row, sig serves as buffer for the packed rows */
+  shake256_init(&state);
+  shake256_absorb(&state, mu, CRHBYTES);
+  for(i = 0; i < K; ++i) {
+    matacc(&w1, rho, rhoprime, nonce, i);
+    poly_caddq(&w1);
+    poly_decompose(&w1, &w0, &w1);
+    polyw1_pack(sig, &w1);
+    shake256_absorb(&state, sig, POLYW1_PACKEDBYTES);
+  }
+  shake256_finalize(&state);
+  shake256_squeeze(sig, CTILDEBYTES, &state);
+  poly_challenge(&t, sig);
+  poly_sparse(&c, &t);
+
+  /* Compute z = y + cs1, reject if it reveals secret */
+  for(j = 0; j < L; ++j) {
+    poly_uniform_gamma1(&w0, rhoprime, L*nonce + j);
+    polyeta_unpack(&t, sk + SK_S1_OFFSET + j*POLYETA_PACKEDBYTES);
+    poly_sparse_mul_add(&w0, &c, &t);
+    if(poly_chknorm(&w0, GAMMA1 - BETA))
+      return 1;
+    polyz_pack(sig + CTILDEBYTES + j*POLYZ_PACKEDBYTES, &w0);
+  }
+
+  /* Check ct0 and w0 - cs2 and compute the hints row by row, recomputing
+   * w. ct0 is checked in w0 first and computed again when it is added, so
+   * three polynomials suffice. All products are exact small integers, on
+   * which poly_reduce does not change anything. The hints are packed as in
+   * pack_sig */
+  n = 0;
+  for(i = 0; i < K; ++i) {
+    polyt0_unpack(&t, sk + SK_T0_OFFSET + i*POLYT0_PACKEDBYTES);
+    for(j = 0; j < N; ++j)
+      w0.coeffs[j] = 0;
+    poly_sparse_mul_add(&w0, &c, &t);
+    if(poly_chknorm(&w0, GAMMA2))
+      return 1;
+
+    matacc(&w1, rho, rhoprime, nonce, i);
+    poly_caddq(&w1);
+    poly_decompose(&w1, &w0, &w1);
+
+    polyeta_unpack(&t, sk + SK_S2_OFFSET + i*POLYETA_PACKEDBYTES);
+    poly_sparse_mul_sub(&w0, &c, &t);
+    if(poly_chknorm(&w0, GAMMA2 - BETA))
+      return 1;
+
+    polyt0_unpack(&t, sk + SK_T0_OFFSET + i*POLYT0_PACKEDBYTES);
+    poly_sparse_mul_add(&w0, &c, &t);
+    if(n + poly_make_hint(&t, &w0, &w1) > OMEGA)
+      return 1;
+    for(j = 0; j < N; ++j)
+      if(t.coeffs[j] != 0)
+        hint[n++] = j;
+    hint[OMEGA + i] = n;
+  }
+
+  for(; n < OMEGA; ++n)
+    hint[n] = 0;
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_signature_extmu_internal
+*
+* Description: Computes signature from mu = CRH(tr, pre, msg) (external mu,
+*              FIPS 204). Internal API. Low-stack version.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *mu:    pointer to mu = CRH(tr, pre, msg) (of length CRHBYTES)
+*              - uint8_t *rnd:   pointer to random seed
+*              - uint8_t *sk:    pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_extmu_internal(uint8_t *sig,
+                                         size_t *siglen,
+                                         const uint8_t mu[CRHBYTES],
+                                         const uint8_t rnd[RNDBYTES],
+                                         const uint8_t *sk)
+{
+  uint8_t rhoprime[CRHBYTES];
+  const uint8_t *key = sk + SEEDBYTES;
+  uint16_t nonce = 0;
+  keccak_state state;
+
+  /* Compute rhoprime = CRH(key, rnd, mu) */
+  shake256_init(&state);
+  shake256_absorb(&state, key, SEEDBYTES);
+  shake256_absorb(&state, rnd, RNDBYTES);
+  shake256_absorb(&state, mu, CRHBYTES);
+  shake256_finalize(&state);
+  shake256_squeeze(rhoprime, CRHBYTES, &state);
+
+  while(sign_attempt(sig, mu, rhoprime, sk, nonce++))
+    ;
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+#endif
+
 /*************************************************
 * Name:        crypto_sign_signature_internal
 *
@@ -114,45 +489,83 @@ int crypto_sign_signature_internal(uint8_t *sig,
                                    size_t prelen,
                                    const uint8_t rnd[RNDBYTES],
                                    const uint8_t *sk)
+{
+  uint8_t mu[CRHBYTES];
+
+  /* tr is stored in sk after rho and key */
+  compute_mu(mu, sk + 2*SEEDBYTES, pre, prelen, m, mlen);
+  return crypto_sign_signature_extmu_internal(sig, siglen, mu, rnd, sk);
+}
+
+/*************************************************
+* Name:        crypto_sign_prepare
+*
+* Description: Expands a secret key for repeated signing: caches the matrix
+*              A, s1, s2 and t0 (in NTT domain, or unpacked for the sparse
+*              multiplication with DILITHIUM_SPARSE_CHALLENGE), tr and key
+*              so that crypto_sign_signature_prepared starts at the
+*              computation of mu
+*
+* Arguments:   - crypto_sign_ctx *prep: pointer to output context
+*              - const uint8_t *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_prepare(crypto_sign_ctx *prep, const uint8_t *sk)
+{
+  uint8_t rho[SEEDBYTES];
+
+  unpack_sk(rho, prep->tr, prep->key, &prep->t0, &prep->s1, &prep->s2, sk);
+  polyvec_matrix_expand(prep->mat, rho);
+#if !DILITHIUM_SPARSE_CHALLENGE
+  polyvecl_ntt(&prep->s1);
+  polyveck_ntt(&prep->s2);
+  polyveck_ntt(&prep->t0);
+#endif
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_signature_prepared_extmu_internal
+*
+* Description: Computes signature from mu = CRH(tr, pre, msg) (external mu,
+*              FIPS 204) with a secret key expanded by crypto_sign_prepare;
+*              same output as crypto_sign_signature_extmu_internal.
+*              Internal API.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *mu:    pointer to mu = CRH(tr, pre, msg) (of length CRHBYTES)
+*              - uint8_t *rnd:   pointer to random seed
+*              - const crypto_sign_ctx *prep: pointer to expanded secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_prepared_extmu_internal(uint8_t *sig,
+                                                  size_t *siglen,
+                                                  const uint8_t mu[CRHBYTES],
+                                                  const uint8_t rnd[RNDBYTES],
+                                                  const crypto_sign_ctx *prep)
 {
   unsigned int n;
-  uint8_t seedbuf[2*SEEDBYTES + TRBYTES + 2*CRHBYTES];
-  uint8_t *rho, *tr, *key, *mu, *rhoprime;
+  uint8_t rhoprime[CRHBYTES];
   uint16_t nonce = 0;
-  polyvecl mat[K], s1, y, z;
-  polyveck t0, s2, w1, w0, h;
+  polyvecl y, z;
+  polyveck w1, w0, h;
   poly cp;
+#if DILITHIUM_SPARSE_CHALLENGE
+  sparsepoly c;
+#endif
   keccak_state state;
 
-  rho = seedbuf;
-  tr = rho + SEEDBYTES;
-  key = tr + TRBYTES;
-  mu = key + SEEDBYTES;
-  rhoprime = mu + CRHBYTES;
-  unpack_sk(rho, tr, key, &t0, &s1, &s2, sk);
-
-  /* Compute mu = CRH(tr, pre, msg) */
-  shake256_init(&state);
-  shake256_absorb(&state, tr, TRBYTES);
-  shake256_absorb(&state, pre, prelen);
-  shake256_absorb(&state, m, mlen);
-  shake256_finalize(&state);
-  shake256_squeeze(mu, CRHBYTES, &state);
-
   /* Compute rhoprime = CRH(key, rnd, mu) */
   shake256_init(&state);
-  shake256_absorb(&state, key, SEEDBYTES);
+  shake256_absorb(&state, prep->key, SEEDBYTES);
   shake256_absorb(&state, rnd, RNDBYTES);
   shake256_absorb(&state, mu, CRHBYTES);
   shake256_finalize(&state);
   shake256_squeeze(rhoprime, CRHBYTES, &state);
 
-  /* Expand matrix and transform vectors */
-  polyvec_matrix_expand(mat, rho);
-  polyvecl_ntt(&s1);
-  polyveck_ntt(&s2);
-  polyveck_ntt(&t0);
-
 rej:
   /* Sample intermediate vector y */
   polyvecl_uniform_gamma1(&y, rhoprime, nonce++);
@@ -160,7 +573,7 @@ rej:
   /* Matrix-vector multiplication */
   z = y;
   polyvecl_ntt(&z);
-  polyvec_matrix_pointwise_montgomery(&w1, mat, &z);
+  polyvec_matrix_pointwise_montgomery(&w1, prep->mat, &z);
   polyveck_reduce(&w1);
   polyveck_invntt_tomont(&w1);
 
@@ -175,11 +588,19 @@ rej:
   shake256_finalize(&state);
   shake256_squeeze(sig, CTILDEBYTES, &state);
   poly_challenge(&cp, sig);
+#if DILITHIUM_SPARSE_CHALLENGE
+  poly_sparse(&c, &cp);
+#else
   poly_ntt(&cp);
+#endif
 
   /* Compute z, reject if it reveals secret */
-  polyvecl_pointwise_poly_montgomery(&z, &cp, &s1);
+#if DILITHIUM_SPARSE_CHALLENGE
+  polyvecl_sparse_mul(&z, &c, &prep->s1);
+#else
+  polyvecl_pointwise_poly_montgomery(&z, &cp, &prep->s1);
   polyvecl_invntt_tomont(&z);
+#endif
   polyvecl_add(&z, &z, &y);
   polyvecl_reduce(&z);
   if(polyvecl_chknorm(&z, GAMMA1 - BETA))
@@ -187,16 +608,24 @@ rej:
 
   /* Check that subtracting cs2 does not change high bits of w and low bits
    * do not reveal secret information */
-  polyveck_pointwise_poly_montgomery(&h, &cp, &s2);
+#if DILITHIUM_SPARSE_CHALLENGE
+  polyveck_sparse_mul(&h, &c, &prep->s2);
+#else
+  polyveck_pointwise_poly_montgomery(&h, &cp, &prep->s2);
   polyveck_invntt_tomont(&h);
+#endif
   polyveck_sub(&w0, &w0, &h);
   polyveck_reduce(&w0);
   if(polyveck_chknorm(&w0, GAMMA2 - BETA))
     goto rej;
 
   /* Compute hints for w1 */
-  polyveck_pointwise_poly_montgomery(&h, &cp, &t0);
+#if DILITHIUM_SPARSE_CHALLENGE
+  polyveck_sparse_mul(&h, &c, &prep->t0);
+#else
+  polyveck_pointwise_poly_montgomery(&h, &cp, &prep->t0);
   polyveck_invntt_tomont(&h);
+#endif
   polyveck_reduce(&h);
   if(polyveck_chknorm(&h, GAMMA2))
     goto rej;
@@ -212,6 +641,39 @@ rej:
   return 0;
 }
 
+/*************************************************
+* Name:        crypto_sign_signature_prepared_internal
+*
+* Description: Computes signature with a secret key expanded by
+*              crypto_sign_prepare; same output as
+*              crypto_sign_signature_internal. Internal API.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *m:     pointer to message to be signed
+*              - size_t mlen:    length of message
+*              - uint8_t *pre:   pointer to prefix string
+*              - size_t prelen:  length of prefix string
+*              - uint8_t *rnd:   pointer to random seed
+*              - const crypto_sign_ctx *prep: pointer to expanded secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_prepared_internal(uint8_t *sig,
+                                            size_t *siglen,
+                                            const uint8_t *m,
+                                            size_t mlen,
+                                            const uint8_t *pre,
+                                            size_t prelen,
+                                            const uint8_t rnd[RNDBYTES],
+                                            const crypto_sign_ctx *prep)
+{
+  uint8_t mu[CRHBYTES];
+
+  compute_mu(mu, prep->tr, pre, prelen, m, mlen);
+  return crypto_sign_signature_prepared_extmu_internal(sig, siglen, mu, rnd, prep);
+}
+
 /*************************************************
 * Name:        crypto_sign_signature
 *
@@ -260,7 +722,86 @@ int crypto_sign_signature(uint8_t *sig,
 }
 
 /*************************************************
-* Name:        crypto_sign
+* Name:        crypto_sign_signature_extmu
+*
+* Description: Computes signature from mu = CRH(tr, pre, msg) (external mu,
+*              FIPS 204).
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *mu:    pointer to mu (of length CRHBYTES)
+*              - uint8_t *sk:    pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_extmu(uint8_t *sig,
+                                size_t *siglen,
+                                const uint8_t mu[CRHBYTES],
+                                const uint8_t *sk)
+{
+  uint8_t rnd[RNDBYTES];
+#ifdef DILITHIUM_RANDOMIZED_SIGNING
+  randombytes(rnd, RNDBYTES);
+#else
+  size_t i;
+
+  for(i=0;i<RNDBYTES;i++)
+    rnd[i] = 0;
+#endif
+
+  return crypto_sign_signature_extmu_internal(sig, siglen, mu, rnd, sk);
+}
+
+/*************************************************
+* Name:        crypto_sign_signature_prepared
+*
+* Description: Computes signature with a secret key expanded by
+*              crypto_sign_prepare; same output as crypto_sign_signature.
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - uint8_t *m:     pointer to message to be signed
+*              - size_t mlen:    length of message
+*              - uint8_t *ctx:   pointer to context string
+*              - size_t ctxlen:  length of context string
+*              - const crypto_sign_ctx *prep: pointer to expanded secret key
+*
+* Returns 0 (success) or -1 (context string too long)
+**************************************************/
+int crypto_sign_signature_prepared(uint8_t *sig,
+                                   size_t *siglen,
+                                   const uint8_t *m,
+                                   size_t mlen,
+                                   const uint8_t *ctx,
+                                   size_t ctxlen,
+                                   const crypto_sign_ctx *prep)
+{
+  size_t i;
+  uint8_t pre[257];
+  uint8_t rnd[RNDBYTES];
+
+  if(ctxlen > 255)
+    return -1;
+
+  /* Prepare pre = (0, ctxlen, ctx) */
+  pre[0] = 0;
+  pre[1] = ctxlen;
+  for(i = 0; i < ctxlen; i++)
+    pre[2 + i] = ctx[i];
+
+#ifdef DILITHIUM_RANDOMIZED_SIGNING
+  randombytes(rnd, RNDBYTES);
+#else
+  for(i=0;i<RNDBYTES;i++)
+    rnd[i] = 0;
+#endif
+
+  crypto_sign_signature_prepared_internal(sig,siglen,m,mlen,pre,2+ctxlen,rnd,prep);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign
 *
 * Description: Compute signed message.
 *
@@ -285,14 +826,16 @@ int crypto_sign(uint8_t *sm,
                 size_t ctxlen,
                 const uint8_t *sk)
 {
-  int ret;
-  size_t i;
+  crypto_sign_stream_ctx stream;
 
-  for(i = 0; i < mlen; ++i)
-    sm[CRYPTO_BYTES + mlen - 1 - i] = m[mlen - 1 - i];
-  ret = crypto_sign_signature(sm, smlen, sm + CRYPTO_BYTES, mlen, ctx, ctxlen, sk);
+  /* Compute mu before m is moved, sm may overlap it */
+  if(crypto_sign_init(&stream, ctx, ctxlen, sk))
+    return -1;
+  crypto_sign_update(&stream, m, mlen);
+  memmove(sm + CRYPTO_BYTES, m, mlen);
+  crypto_sign_final(sm, smlen, &stream);
   *smlen += mlen;
-  return ret;
+  return 0;
 }
 
 /*************************************************
@@ -317,49 +860,131 @@ int crypto_sign_verify_internal(const uint8_t *sig,
                                 const uint8_t *pre,
                                 size_t prelen,
                                 const uint8_t *pk)
+{
+  uint8_t mu[CRHBYTES];
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  /* Compute CRH(H(rho, t1), pre, msg) */
+  shake256(mu, TRBYTES, pk, CRYPTO_PUBLICKEYBYTES);
+  compute_mu(mu, mu, pre, prelen, m, mlen);
+  return crypto_sign_verify_extmu(sig, siglen, mu, pk);
+}
+
+/*************************************************
+* Name:        expand_pk
+*
+* Description: Expands the lattice part of a public key: the matrix A and
+*              t1*2^d in NTT domain. tr is left untouched.
+*
+* Arguments:   - crypto_sign_verify_ctx *prep: pointer to output context
+*              - const uint8_t *pk: pointer to bit-packed public key
+**************************************************/
+static void expand_pk(crypto_sign_verify_ctx *prep, const uint8_t *pk)
+{
+  uint8_t rho[SEEDBYTES];
+
+  unpack_pk(rho, &prep->t1, pk);
+  polyvec_matrix_expand(prep->mat, rho);
+  polyveck_shiftl(&prep->t1);
+  polyveck_ntt(&prep->t1);
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_extmu
+*
+* Description: Verifies signature against mu = CRH(tr, pre, msg) (external
+*              mu, FIPS 204). pk is not hashed.
+*
+* Arguments:   - uint8_t *sig: pointer to input signature
+*              - size_t siglen: length of signature
+*              - const uint8_t *mu: pointer to mu (of length CRHBYTES)
+*              - const uint8_t *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_extmu(const uint8_t *sig,
+                             size_t siglen,
+                             const uint8_t mu[CRHBYTES],
+                             const uint8_t *pk)
+{
+  crypto_sign_verify_ctx prep;
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  expand_pk(&prep, pk);
+  return crypto_sign_verify_prepared_extmu(sig, siglen, mu, &prep);
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_prepare
+*
+* Description: Expands a public key for repeated verification: caches
+*              tr = H(pk), the matrix A and t1*2^d in NTT domain so that
+*              crypto_sign_verify_prepared only does the per-signature work
+*
+* Arguments:   - crypto_sign_verify_ctx *prep: pointer to output context
+*              - const uint8_t *pk: pointer to bit-packed public key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_prepare(crypto_sign_verify_ctx *prep, const uint8_t *pk)
+{
+  expand_pk(prep, pk);
+  shake256(prep->tr, TRBYTES, pk, CRYPTO_PUBLICKEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_prepared_extmu
+*
+* Description: Verifies signature against mu = CRH(tr, pre, msg) (external
+*              mu, FIPS 204) with a public key expanded by
+*              crypto_sign_verify_prepare
+*
+* Arguments:   - uint8_t *sig: pointer to input signature
+*              - size_t siglen: length of signature
+*              - const uint8_t *mu: pointer to mu (of length CRHBYTES)
+*              - const crypto_sign_verify_ctx *prep: pointer to expanded
+*                                                    public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_prepared_extmu(const uint8_t *sig,
+                                      size_t siglen,
+                                      const uint8_t mu[CRHBYTES],
+                                      const crypto_sign_verify_ctx *prep)
 {
   unsigned int i;
   uint8_t buf[K*POLYW1_PACKEDBYTES];
-  uint8_t rho[SEEDBYTES];
-  uint8_t mu[CRHBYTES];
   uint8_t c[CTILDEBYTES];
   uint8_t c2[CTILDEBYTES];
-  poly cp;
-  polyvecl mat[K], z;
-  polyveck t1, w1, h;
+  poly cp, t;
+  polyvecl z;
+  polyveck w1, h;
   keccak_state state;
 
   if(siglen != CRYPTO_BYTES)
     return -1;
 
-  unpack_pk(rho, &t1, pk);
   if(unpack_sig(c, &z, &h, sig))
     return -1;
   if(polyvecl_chknorm(&z, GAMMA1 - BETA))
     return -1;
 
-  /* Compute CRH(H(rho, t1), pre, msg) */
-  shake256(mu, TRBYTES, pk, CRYPTO_PUBLICKEYBYTES);
-  shake256_init(&state);
-  shake256_absorb(&state, mu, TRBYTES);
-  shake256_absorb(&state, pre, prelen);
-  shake256_absorb(&state, m, mlen);
-  shake256_finalize(&state);
-  shake256_squeeze(mu, CRHBYTES, &state);
-
   /* Matrix-vector multiplication; compute Az - c2^dt1 */
   poly_challenge(&cp, c);
-  polyvec_matrix_expand(mat, rho);
 
   polyvecl_ntt(&z);
-  polyvec_matrix_pointwise_montgomery(&w1, mat, &z);
+  polyvec_matrix_pointwise_montgomery(&w1, prep->mat, &z);
 
   poly_ntt(&cp);
-  polyveck_shiftl(&t1);
-  polyveck_ntt(&t1);
-  polyveck_pointwise_poly_montgomery(&t1, &cp, &t1);
-
-  polyveck_sub(&w1, &w1, &t1);
+  for(i = 0; i < K; ++i) {
+    poly_pointwise_montgomery(&t, &cp, &prep->t1.vec[i]);
+    poly_sub(&w1.vec[i], &w1.vec[i], &t);
+  }
   polyveck_reduce(&w1);
   polyveck_invntt_tomont(&w1);
 
@@ -381,6 +1006,41 @@ int crypto_sign_verify_internal(const uint8_t *sig,
   return 0;
 }
 
+/*************************************************
+* Name:        crypto_sign_verify_prepared_internal
+*
+* Description: Verifies signature with a public key expanded by
+*              crypto_sign_verify_prepare; same result as
+*              crypto_sign_verify_internal. Internal API.
+*
+* Arguments:   - uint8_t *m: pointer to input signature
+*              - size_t siglen: length of signature
+*              - const uint8_t *m: pointer to message
+*              - size_t mlen: length of message
+*              - const uint8_t *pre: pointer to prefix string
+*              - size_t prelen: length of prefix string
+*              - const crypto_sign_verify_ctx *prep: pointer to expanded
+*                                                    public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_prepared_internal(const uint8_t *sig,
+                                         size_t siglen,
+                                         const uint8_t *m,
+                                         size_t mlen,
+                                         const uint8_t *pre,
+                                         size_t prelen,
+                                         const crypto_sign_verify_ctx *prep)
+{
+  uint8_t mu[CRHBYTES];
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  compute_mu(mu, prep->tr, pre, prelen, m, mlen);
+  return crypto_sign_verify_prepared_extmu(sig, siglen, mu, prep);
+}
+
 /*************************************************
 * Name:        crypto_sign_verify
 *
@@ -418,6 +1078,45 @@ int crypto_sign_verify(const uint8_t *sig,
   return crypto_sign_verify_internal(sig,siglen,m,mlen,pre,2+ctxlen,pk);
 }
 
+/*************************************************
+* Name:        crypto_sign_verify_prepared
+*
+* Description: Verifies signature with a public key expanded by
+*              crypto_sign_verify_prepare; same result as crypto_sign_verify.
+*
+* Arguments:   - uint8_t *m: pointer to input signature
+*              - size_t siglen: length of signature
+*              - const uint8_t *m: pointer to message
+*              - size_t mlen: length of message
+*              - const uint8_t *ctx: pointer to context string
+*              - size_t ctxlen: length of context string
+*              - const crypto_sign_verify_ctx *prep: pointer to expanded
+*                                                    public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_prepared(const uint8_t *sig,
+                                size_t siglen,
+                                const uint8_t *m,
+                                size_t mlen,
+                                const uint8_t *ctx,
+                                size_t ctxlen,
+                                const crypto_sign_verify_ctx *prep)
+{
+  size_t i;
+  uint8_t pre[257];
+
+  if(ctxlen > 255)
+    return -1;
+
+  pre[0] = 0;
+  pre[1] = ctxlen;
+  for(i = 0; i < ctxlen; i++)
+    pre[2 + i] = ctx[i];
+
+  return crypto_sign_verify_prepared_internal(sig,siglen,m,mlen,pre,2+ctxlen,prep);
+}
+
 /*************************************************
 * Name:        crypto_sign_open
 *
@@ -442,8 +1141,6 @@ int crypto_sign_open(uint8_t *m,
                      size_t ctxlen,
                      const uint8_t *pk)
 {
-  size_t i;
-
   if(smlen < CRYPTO_BYTES)
     goto badsig;
 
@@ -452,16 +1149,235 @@ int crypto_sign_open(uint8_t *m,
     goto badsig;
   else {
     /* All good, copy msg, return 0 */
-    for(i = 0; i < *mlen; ++i)
-      m[i] = sm[CRYPTO_BYTES + i];
+    memmove(m, sm + CRYPTO_BYTES, *mlen);
     return 0;
   }
 
 badsig:
   /* Signature verification failed */
   *mlen = 0;
-  for(i = 0; i < smlen; ++i)
-    m[i] = 0;
+  memset(m, 0, smlen);
 
   return -1;
 }
+
+/*************************************************
+* Name:        mu_init
+*
+* Description: Starts the computation of mu = CRH(tr, pre, msg) with
+*              pre = (0, ctxlen, ctx)
+*
+* Arguments:   - crypto_sign_mu_state *mu: pointer to output state
+*              - const uint8_t *ctx: pointer to context string
+*              - size_t ctxlen: length of context string
+*              - const uint8_t *tr: pointer to tr = H(pk) (of length TRBYTES)
+*
+* Returns 0 (success) or -1 (context string too long)
+**************************************************/
+static int mu_init(crypto_sign_mu_state *mu,
+                   const uint8_t *ctx,
+                   size_t ctxlen,
+                   const uint8_t tr[TRBYTES])
+{
+  uint8_t pre[2];
+
+  if(ctxlen > 255)
+    return -1;
+
+  pre[0] = 0;
+  pre[1] = ctxlen;
+  shake256_init(&mu->state);
+  shake256_absorb(&mu->state, tr, TRBYTES);
+  shake256_absorb(&mu->state, pre, 2);
+  shake256_absorb(&mu->state, ctx, ctxlen);
+  return 0;
+}
+
+/*************************************************
+* Name:        mu_final
+*
+* Description: Finishes the computation of mu
+*
+* Arguments:   - uint8_t *out: pointer to output mu (of length CRHBYTES)
+*              - crypto_sign_mu_state *mu: pointer to state
+**************************************************/
+static void mu_final(uint8_t out[CRHBYTES], crypto_sign_mu_state *mu)
+{
+  shake256_finalize(&mu->state);
+  shake256_squeeze(out, CRHBYTES, &mu->state);
+}
+
+/*************************************************
+* Name:        crypto_sign_init
+*
+* Description: Starts an incremental signature for a message that is passed
+*              in chunks to crypto_sign_update. Only the SHAKE256 state of
+*              mu is kept; the message is never stored.
+*
+* Arguments:   - crypto_sign_stream_ctx *stream: pointer to output context
+*              - const uint8_t *ctx: pointer to context string
+*              - size_t ctxlen: length of context string
+*              - const uint8_t *sk: pointer to bit-packed secret key, which
+*                                   has to stay available until
+*                                   crypto_sign_final
+*
+* Returns 0 (success) or -1 (context string too long)
+**************************************************/
+int crypto_sign_init(crypto_sign_stream_ctx *stream,
+                     const uint8_t *ctx,
+                     size_t ctxlen,
+                     const uint8_t *sk)
+{
+  stream->sk = sk;
+  /* tr is stored in sk after rho and key */
+  return mu_init(&stream->mu, ctx, ctxlen, sk + 2*SEEDBYTES);
+}
+
+/*************************************************
+* Name:        crypto_sign_update
+*
+* Description: Passes the next chunk of the message to an incremental
+*              signature
+*
+* Arguments:   - crypto_sign_stream_ctx *stream: pointer to context
+*              - const uint8_t *m: pointer to the chunk
+*              - size_t mlen: length of the chunk in bytes
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_update(crypto_sign_stream_ctx *stream,
+                       const uint8_t *m,
+                       size_t mlen)
+{
+  shake256_absorb(&stream->mu.state, m, mlen);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_final_mu
+*
+* Description: Finishes the computation of mu instead of the signature,
+*              e.g. to pass it to crypto_sign_signature_extmu on another
+*              device
+*
+* Arguments:   - uint8_t *mu: pointer to output mu (of length CRHBYTES)
+*              - crypto_sign_stream_ctx *stream: pointer to context
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_final_mu(uint8_t mu[CRHBYTES],
+                         crypto_sign_stream_ctx *stream)
+{
+  mu_final(mu, &stream->mu);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_final
+*
+* Description: Finishes an incremental signature; same output as
+*              crypto_sign_signature on the concatenated chunks
+*
+* Arguments:   - uint8_t *sig:   pointer to output signature (of length CRYPTO_BYTES)
+*              - size_t *siglen: pointer to output length of signature
+*              - crypto_sign_stream_ctx *stream: pointer to context
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_final(uint8_t *sig,
+                      size_t *siglen,
+                      crypto_sign_stream_ctx *stream)
+{
+  uint8_t mu[CRHBYTES];
+
+  mu_final(mu, &stream->mu);
+  return crypto_sign_signature_extmu(sig, siglen, mu, stream->sk);
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_init
+*
+* Description: Starts an incremental verification for a message that is
+*              passed in chunks to crypto_sign_verify_update
+*
+* Arguments:   - crypto_verify_stream_ctx *stream: pointer to output context
+*              - const uint8_t *ctx: pointer to context string
+*              - size_t ctxlen: length of context string
+*              - const uint8_t *pk: pointer to bit-packed public key, which
+*                                   has to stay available until
+*                                   crypto_sign_verify_final
+*
+* Returns 0 (success) or -1 (context string too long)
+**************************************************/
+int crypto_sign_verify_init(crypto_verify_stream_ctx *stream,
+                            const uint8_t *ctx,
+                            size_t ctxlen,
+                            const uint8_t *pk)
+{
+  uint8_t tr[TRBYTES];
+
+  stream->pk = pk;
+  shake256(tr, TRBYTES, pk, CRYPTO_PUBLICKEYBYTES);
+  return mu_init(&stream->mu, ctx, ctxlen, tr);
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_update
+*
+* Description: Passes the next chunk of the message to an incremental
+*              verification
+*
+* Arguments:   - crypto_verify_stream_ctx *stream: pointer to context
+*              - const uint8_t *m: pointer to the chunk
+*              - size_t mlen: length of the chunk in bytes
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_update(crypto_verify_stream_ctx *stream,
+                              const uint8_t *m,
+                              size_t mlen)
+{
+  shake256_absorb(&stream->mu.state, m, mlen);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_final_mu
+*
+* Description: Finishes the computation of mu instead of the verification,
+*              e.g. to pass it to crypto_sign_verify_extmu on another
+*              device
+*
+* Arguments:   - uint8_t *mu: pointer to output mu (of length CRHBYTES)
+*              - crypto_verify_stream_ctx *stream: pointer to context
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_final_mu(uint8_t mu[CRHBYTES],
+                                crypto_verify_stream_ctx *stream)
+{
+  mu_final(mu, &stream->mu);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_final
+*
+* Description: Finishes an incremental verification; same result as
+*              crypto_sign_verify on the concatenated chunks
+*
+* Arguments:   - uint8_t *sig: pointer to input signature
+*              - size_t siglen: length of signature
+*              - crypto_verify_stream_ctx *stream: pointer to context
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_final(const uint8_t *sig,
+                             size_t siglen,
+                             crypto_verify_stream_ctx *stream)
+{
+  uint8_t mu[CRHBYTES];
+
+  mu_final(mu, &stream->mu);
+  return crypto_sign_verify_extmu(sig, siglen, mu, stream->pk);
+}
@@ -24,6 +24,18 @@ int crypto_sign_signature_internal(uint8_t *sig,
                                    const uint8_t rnd[RNDBYTES],
                                    const uint8_t *sk);
 
+#define crypto_sign_signature_extmu_internal DILITHIUM_NAMESPACE(signature_extmu_internal)
+int crypto_sign_signature_extmu_internal(uint8_t *sig,
+                                         size_t *siglen,
+                                         const uint8_t mu[CRHBYTES],
+                                         const uint8_t rnd[RNDBYTES],
+                                         const uint8_t *sk);
+
+#define crypto_sign_signature_extmu DILITHIUM_NAMESPACE(signature_extmu)
+int crypto_sign_signature_extmu(uint8_t *sig, size_t *siglen,
+                                const uint8_t mu[CRHBYTES],
+                                const uint8_t *sk);
+
 #define crypto_sign_signature DILITHIUM_NAMESPACE(signature)
 int crypto_sign_signature(uint8_t *sig, size_t *siglen,
                           const uint8_t *m, size_t mlen,
@@ -45,6 +57,11 @@ int crypto_sign_verify_internal(const uint8_t *sig,
                                 size_t prelen,
                                 const uint8_t *pk);
 
+#define crypto_sign_verify_extmu DILITHIUM_NAMESPACE(verify_extmu)
+int crypto_sign_verify_extmu(const uint8_t *sig, size_t siglen,
+                             const uint8_t mu[CRHBYTES],
+                             const uint8_t *pk);
+
 #define crypto_sign_verify DILITHIUM_NAMESPACE(verify)
 int crypto_sign_verify(const uint8_t *sig, size_t siglen,
                        const uint8_t *m, size_t mlen,
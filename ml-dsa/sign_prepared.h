@@ -0,0 +1,83 @@
+#ifndef SIGN_PREPARED_H
+#define SIGN_PREPARED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "polyvec.h"
+
+/*
+ * Secret key expanded for repeated signing, see crypto_sign_prepare. s1, s2
+ * and t0 are in NTT domain, or unpacked in normal domain where signing uses
+ * the sparse challenge multiplication (see sign.c)
+ */
+typedef struct {
+  polyvecl mat[K];
+  polyvecl s1;
+  polyveck s2;
+  polyveck t0;
+  uint8_t tr[TRBYTES];
+  uint8_t key[SEEDBYTES];
+} crypto_sign_ctx;
+
+#define crypto_sign_prepare DILITHIUM_NAMESPACE(sign_prepare)
+int crypto_sign_prepare(crypto_sign_ctx *prep, const uint8_t *sk);
+
+#define crypto_sign_signature_prepared_extmu_internal DILITHIUM_NAMESPACE(signature_prepared_extmu_internal)
+int crypto_sign_signature_prepared_extmu_internal(uint8_t *sig,
+                                                  size_t *siglen,
+                                                  const uint8_t mu[CRHBYTES],
+                                                  const uint8_t rnd[RNDBYTES],
+                                                  const crypto_sign_ctx *prep);
+
+#define crypto_sign_signature_prepared_internal DILITHIUM_NAMESPACE(signature_prepared_internal)
+int crypto_sign_signature_prepared_internal(uint8_t *sig,
+                                            size_t *siglen,
+                                            const uint8_t *m,
+                                            size_t mlen,
+                                            const uint8_t *pre,
+                                            size_t prelen,
+                                            const uint8_t rnd[RNDBYTES],
+                                            const crypto_sign_ctx *prep);
+
+#define crypto_sign_signature_prepared DILITHIUM_NAMESPACE(signature_prepared)
+int crypto_sign_signature_prepared(uint8_t *sig, size_t *siglen,
+                                   const uint8_t *m, size_t mlen,
+                                   const uint8_t *ctx, size_t ctxlen,
+                                   const crypto_sign_ctx *prep);
+
+/*
+ * Public key expanded for repeated verification, see
+ * crypto_sign_verify_prepare. t1 holds NTT(t1*2^d)
+ */
+typedef struct {
+  polyvecl mat[K];
+  polyveck t1;
+  uint8_t tr[TRBYTES];
+} crypto_sign_verify_ctx;
+
+#define crypto_sign_verify_prepare DILITHIUM_NAMESPACE(verify_prepare)
+int crypto_sign_verify_prepare(crypto_sign_verify_ctx *prep, const uint8_t *pk);
+
+#define crypto_sign_verify_prepared_extmu DILITHIUM_NAMESPACE(verify_prepared_extmu)
+int crypto_sign_verify_prepared_extmu(const uint8_t *sig,
+                                      size_t siglen,
+                                      const uint8_t mu[CRHBYTES],
+                                      const crypto_sign_verify_ctx *prep);
+
+#define crypto_sign_verify_prepared_internal DILITHIUM_NAMESPACE(verify_prepared_internal)
+int crypto_sign_verify_prepared_internal(const uint8_t *sig,
+                                         size_t siglen,
+                                         const uint8_t *m,
+                                         size_t mlen,
+                                         const uint8_t *pre,
+                                         size_t prelen,
+                                         const crypto_sign_verify_ctx *prep);
+
+#define crypto_sign_verify_prepared DILITHIUM_NAMESPACE(verify_prepared)
+int crypto_sign_verify_prepared(const uint8_t *sig, size_t siglen,
+                                const uint8_t *m, size_t mlen,
+                                const uint8_t *ctx, size_t ctxlen,
+                                const crypto_sign_verify_ctx *prep);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SIGN_STREAM_H
+#define SIGN_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "fips202.h"
+
+/*
+ * SHAKE256 state of mu = CRH(tr, pre, msg) while the message arrives in
+ * chunks; the message itself is never stored
+ */
+typedef struct {
+  keccak_state state;
+} crypto_sign_mu_state;
+
+/* Incremental signature, see crypto_sign_init */
+typedef struct {
+  crypto_sign_mu_state mu;
+  const uint8_t *sk;
+} crypto_sign_stream_ctx;
+
+/* Incremental verification, see crypto_sign_verify_init */
+typedef struct {
+  crypto_sign_mu_state mu;
+  const uint8_t *pk;
+} crypto_verify_stream_ctx;
+
+#define crypto_sign_init DILITHIUM_NAMESPACE(sign_init)
+int crypto_sign_init(crypto_sign_stream_ctx *stream,
+                     const uint8_t *ctx, size_t ctxlen,
+                     const uint8_t *sk);
+
+#define crypto_sign_update DILITHIUM_NAMESPACE(sign_update)
+int crypto_sign_update(crypto_sign_stream_ctx *stream, const uint8_t *m, size_t mlen);
+
+#define crypto_sign_final_mu DILITHIUM_NAMESPACE(sign_final_mu)
+int crypto_sign_final_mu(uint8_t mu[CRHBYTES], crypto_sign_stream_ctx *stream);
+
+#define crypto_sign_final DILITHIUM_NAMESPACE(sign_final)
+int crypto_sign_final(uint8_t *sig, size_t *siglen, crypto_sign_stream_ctx *stream);
+
+#define crypto_sign_verify_init DILITHIUM_NAMESPACE(verify_init)
+int crypto_sign_verify_init(crypto_verify_stream_ctx *stream,
+                            const uint8_t *ctx, size_t ctxlen,
+                            const uint8_t *pk);
+
+#define crypto_sign_verify_update DILITHIUM_NAMESPACE(verify_update)
+int crypto_sign_verify_update(crypto_verify_stream_ctx *stream, const uint8_t *m, size_t mlen);
+
+#define crypto_sign_verify_final_mu DILITHIUM_NAMESPACE(verify_final_mu)
+int crypto_sign_verify_final_mu(uint8_t mu[CRHBYTES], crypto_verify_stream_ctx *stream);
+
+#define crypto_sign_verify_final DILITHIUM_NAMESPACE(verify_final)
+int crypto_sign_verify_final(const uint8_t *sig, size_t siglen, crypto_verify_stream_ctx *stream);
+
+#endif
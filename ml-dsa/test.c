@@ -5,6 +5,8 @@
 #include "hal.h"
 #include "randombytes.h"
 #include "sign.h"
+#include "sign_prepared.h"
+#include "sign_stream.h"
 #include "params.h"
 
 #include "testvectors.inc"
@@ -190,6 +192,182 @@ static int test_functional(void)
     return 0;
 }
 
+static int test_signature_prepared_vector(void)
+{
+    static crypto_sign_ctx prep;
+    uint8_t sig[CRYPTO_BYTES];
+    uint8_t pre[257]; // Maximum prefix size (0 + ctxlen + ctx)
+    size_t siglen;
+    size_t ctxlen = sizeof(tv_sign_ctx);
+    size_t i;
+
+    hal_send_str("\n=== Test 6: Prepared Signature Generation ===\n");
+
+    pre[0] = 0;
+    pre[1] = ctxlen;
+    for(i = 0; i < ctxlen; i++) {
+        pre[2 + i] = tv_sign_ctx[i];
+    }
+
+    // Expand the test vector secret key once, then sign twice
+    crypto_sign_prepare(&prep, tv_sign_sk);
+    for(i = 0; i < 2; i++) {
+        if(crypto_sign_signature_prepared_internal(sig, &siglen,
+                                                   tv_sign_message, sizeof(tv_sign_message),
+                                                   pre, 2 + ctxlen,
+                                                   tv_sign_rnd, &prep) != 0) {
+            hal_send_str("Prepared signature generation failed!\n");
+            return -1;
+        }
+        if(memcmp(sig, tv_expected_sig, CRYPTO_BYTES) != 0) {
+            hal_send_str("Signature mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Prepared signature generation test vector PASSED\n");
+    return 0;
+}
+
+static int test_verify_prepared_vector(void)
+{
+    static crypto_sign_verify_ctx prep;
+    uint8_t pre[257]; // Maximum prefix size (0 + ctxlen + ctx)
+    size_t i;
+
+    hal_send_str("\n=== Test 7: Prepared Signature Verification ===\n");
+
+    // Valid signature, verified twice with one expanded public key
+    pre[0] = 0;
+    pre[1] = sizeof(tv_verify_pos_ctx);
+    for(i = 0; i < sizeof(tv_verify_pos_ctx); i++) {
+        pre[2 + i] = tv_verify_pos_ctx[i];
+    }
+    crypto_sign_verify_prepare(&prep, tv_verify_pos_pk);
+    for(i = 0; i < 2; i++) {
+        if(crypto_sign_verify_prepared_internal(tv_verify_pos_sig, CRYPTO_BYTES,
+                                                tv_verify_pos_message, sizeof(tv_verify_pos_message),
+                                                pre, 2 + sizeof(tv_verify_pos_ctx),
+                                                &prep) != 0) {
+            hal_send_str("Valid signature verification failed (unexpected)!\n");
+            return -1;
+        }
+    }
+
+    // Invalid signature
+    pre[1] = sizeof(tv_verify_neg_ctx);
+    for(i = 0; i < sizeof(tv_verify_neg_ctx); i++) {
+        pre[2 + i] = tv_verify_neg_ctx[i];
+    }
+    crypto_sign_verify_prepare(&prep, tv_verify_neg_pk);
+    if(crypto_sign_verify_prepared_internal(tv_verify_neg_sig, CRYPTO_BYTES,
+                                            tv_verify_neg_message, sizeof(tv_verify_neg_message),
+                                            pre, 2 + sizeof(tv_verify_neg_ctx),
+                                            &prep) == 0) {
+        hal_send_str("Invalid signature verification passed (unexpected)!\n");
+        return -1;
+    }
+
+    hal_send_str("✓ Prepared signature verification test vectors PASSED\n");
+    return 0;
+}
+
+// Passes m to whichever of the incremental signature and verification is
+// not NULL, in chunks of 1, 2, 3, ... bytes
+static void update_chunked(crypto_sign_stream_ctx *sign, crypto_verify_stream_ctx *verify,
+                           const uint8_t *m, size_t mlen)
+{
+    size_t n = 1;
+
+    while(mlen > 0) {
+        if(n > mlen) {
+            n = mlen;
+        }
+        if(sign) {
+            crypto_sign_update(sign, m, n);
+        } else {
+            crypto_sign_verify_update(verify, m, n);
+        }
+        m += n;
+        mlen -= n;
+        n++;
+    }
+}
+
+static int test_stream_extmu(void)
+{
+    static uint8_t sm[CRYPTO_BYTES + 300];
+    uint8_t pk[CRYPTO_PUBLICKEYBYTES];
+    uint8_t sk[CRYPTO_SECRETKEYBYTES];
+    uint8_t sig[CRYPTO_BYTES];
+    uint8_t mu[CRHBYTES];
+    uint8_t message[300];
+    uint8_t ctx[3] = {1, 2, 3};
+    crypto_sign_stream_ctx stream;
+    crypto_verify_stream_ctx vstream;
+    size_t siglen, smlen, mlen;
+    size_t i;
+
+    hal_send_str("\n=== Test 8: Incremental Signing and External Mu ===\n");
+
+    // Signature test vector: mu from the stream, then external-mu signing
+    crypto_sign_init(&stream, tv_sign_ctx, sizeof(tv_sign_ctx), tv_sign_sk);
+    update_chunked(&stream, NULL, tv_sign_message, sizeof(tv_sign_message));
+    crypto_sign_final_mu(mu, &stream);
+    crypto_sign_signature_extmu_internal(sig, &siglen, mu, tv_sign_rnd, tv_sign_sk);
+    if(memcmp(sig, tv_expected_sig, CRYPTO_BYTES) != 0) {
+        hal_send_str("External-mu signature mismatch!\n");
+        return -1;
+    }
+
+    // Verification test vectors through the stream
+    crypto_sign_verify_init(&vstream, tv_verify_pos_ctx, sizeof(tv_verify_pos_ctx), tv_verify_pos_pk);
+    update_chunked(NULL, &vstream, tv_verify_pos_message, sizeof(tv_verify_pos_message));
+    if(crypto_sign_verify_final(tv_verify_pos_sig, CRYPTO_BYTES, &vstream) != 0) {
+        hal_send_str("Valid signature verification failed (unexpected)!\n");
+        return -1;
+    }
+    crypto_sign_verify_init(&vstream, tv_verify_neg_ctx, sizeof(tv_verify_neg_ctx), tv_verify_neg_pk);
+    update_chunked(NULL, &vstream, tv_verify_neg_message, sizeof(tv_verify_neg_message));
+    if(crypto_sign_verify_final(tv_verify_neg_sig, CRYPTO_BYTES, &vstream) == 0) {
+        hal_send_str("Invalid signature verification passed (unexpected)!\n");
+        return -1;
+    }
+
+    // A longer message signed in chunks verifies in one piece and with an
+    // external mu
+    for(i = 0; i < sizeof(message); i++) {
+        message[i] = i;
+    }
+    crypto_sign_keypair(pk, sk);
+    crypto_sign_init(&stream, ctx, sizeof(ctx), sk);
+    update_chunked(&stream, NULL, message, sizeof(message));
+    crypto_sign_final(sig, &siglen, &stream);
+    if(crypto_sign_verify(sig, siglen, message, sizeof(message), ctx, sizeof(ctx), pk) != 0) {
+        hal_send_str("Incremental signature verification failed!\n");
+        return -1;
+    }
+    crypto_sign_verify_init(&vstream, ctx, sizeof(ctx), pk);
+    crypto_sign_verify_update(&vstream, message, sizeof(message));
+    crypto_sign_verify_final_mu(mu, &vstream);
+    if(crypto_sign_verify_extmu(sig, siglen, mu, pk) != 0) {
+        hal_send_str("External-mu verification failed!\n");
+        return -1;
+    }
+
+    // Signed message in place
+    memcpy(sm, message, sizeof(message));
+    crypto_sign(sm, &smlen, sm, sizeof(message), ctx, sizeof(ctx), sk);
+    if(crypto_sign_open(sm, &mlen, sm, smlen, ctx, sizeof(ctx), pk) != 0 ||
+       mlen != sizeof(message) || memcmp(sm, message, sizeof(message)) != 0) {
+        hal_send_str("Signed message mismatch!\n");
+        return -1;
+    }
+
+    hal_send_str("✓ Incremental signing and external mu PASSED\n");
+    return 0;
+}
+
 static void run_speed(void)
 {
     uint8_t pk[CRYPTO_PUBLICKEYBYTES];
@@ -198,6 +376,8 @@ static void run_speed(void)
     uint8_t message[53];
     uint8_t rnd[RNDBYTES];
     uint8_t ctx[1] = {0};
+    static crypto_sign_ctx prep;
+    static crypto_sign_verify_ctx verify_prep;
     size_t siglen;
     uint64_t cycles;
     char cycles_str[64];
@@ -226,7 +406,7 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -239,7 +419,21 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // Prepared signature generation benchmark (per-message work only)
+    crypto_sign_prepare(&prep, sk);
+    cycles = hal_get_time();
+    crypto_sign_signature_prepared_internal(sig, &siglen, message, 53, ctx, 0, rnd, &prep);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for prepared signature generation: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -252,7 +446,21 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // Prepared signature verification benchmark (per-signature work only)
+    crypto_sign_verify_prepare(&verify_prep, pk);
+    cycles = hal_get_time();
+    crypto_sign_verify_prepared_internal(sig, siglen, message, 53, ctx, 0, &verify_prep);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for prepared signature verification: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -265,7 +473,7 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -356,6 +564,27 @@ int main(void)
         return -1;
     }
 
+    // Sixth test: prepared signing against the test vectors
+    test_result = test_signature_prepared_vector();
+    if(test_result != 0) {
+        hal_send_str("\n*** TEST FAILED ***\n");
+        return -1;
+    }
+
+    // Seventh test: prepared verification against the test vectors
+    test_result = test_verify_prepared_vector();
+    if(test_result != 0) {
+        hal_send_str("\n*** TEST FAILED ***\n");
+        return -1;
+    }
+
+    // Eighth test: incremental signing and external mu
+    test_result = test_stream_extmu();
+    if(test_result != 0) {
+        hal_send_str("\n*** TEST FAILED ***\n");
+        return -1;
+    }
+
     run_speed();
     run_stack();
 
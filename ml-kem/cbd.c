@@ -2,48 +2,59 @@
 #include "params.h"
 #include "cbd.h"
 
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
+#if defined(__ARM_FEATURE_DSP)
 /*************************************************
-* Name:        load32_littleendian
+* Name:        cbd2
 *
-* Description: load 4 bytes into a 32-bit integer
-*              in little-endian order
+* Description: Given an array of uniformly random bytes, compute
+*              polynomial with coefficients distributed according to
+*              a centered binomial distribution with parameter eta=2.
+*              Cortex-M4 implementation in cbd_m4.S
 *
-* Arguments:   - const uint8_t *x: pointer to input byte array
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+static void cbd2(poly *r, const uint8_t buf[2*KYBER_N/4])
+{
+  cbd2_m4(r->coeffs, buf);
+}
+#elif defined(__AVX2__)
+/*************************************************
+* Name:        cbd2
 *
-* Returns 32-bit unsigned integer loaded from x
+* Description: Given an array of uniformly random bytes, compute
+*              polynomial with coefficients distributed according to
+*              a centered binomial distribution with parameter eta=2.
+*              AVX2 implementation in cbd_avx2.c
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array
 **************************************************/
-static uint32_t load32_littleendian(const uint8_t x[4])
+static void cbd2(poly *r, const uint8_t buf[2*KYBER_N/4])
 {
-  uint32_t r;
-  r  = (uint32_t)x[0];
-  r |= (uint32_t)x[1] << 8;
-  r |= (uint32_t)x[2] << 16;
-  r |= (uint32_t)x[3] << 24;
-  return r;
+  cbd2_avx2(r->coeffs, buf);
 }
-
+#else
 /*************************************************
-* Name:        load24_littleendian
+* Name:        load32_littleendian
 *
-* Description: load 3 bytes into a 32-bit integer
-*              in little-endian order.
-*              This function is only needed for Kyber-512
+* Description: load 4 bytes into a 32-bit integer
+*              in little-endian order
 *
 * Arguments:   - const uint8_t *x: pointer to input byte array
 *
-* Returns 32-bit unsigned integer loaded from x (most significant byte is zero)
+* Returns 32-bit unsigned integer loaded from x
 **************************************************/
-#if KYBER_ETA1 == 3
-static uint32_t load24_littleendian(const uint8_t x[3])
+static uint32_t load32_littleendian(const uint8_t x[4])
 {
   uint32_t r;
   r  = (uint32_t)x[0];
   r |= (uint32_t)x[1] << 8;
   r |= (uint32_t)x[2] << 16;
+  r |= (uint32_t)x[3] << 24;
   return r;
 }
-#endif
-
 
 /*************************************************
 * Name:        cbd2
@@ -73,6 +84,73 @@ static void cbd2(poly *r, const uint8_t buf[2*KYBER_N/4])
     }
   }
 }
+#endif
+
+void poly_cbd_eta2(poly *r, const uint8_t buf[KYBER_ETA2*KYBER_N/4])
+{
+#if KYBER_ETA2 == 2
+  cbd2(r, buf);
+#else
+#error "This implementation requires eta2 = 2"
+#endif
+}
+#endif
+
+#if KYBER_ETA1 == 3
+#if defined(__ARM_FEATURE_DSP)
+/*************************************************
+* Name:        cbd3
+*
+* Description: Given an array of uniformly random bytes, compute
+*              polynomial with coefficients distributed according to
+*              a centered binomial distribution with parameter eta=3.
+*              This function is only needed for Kyber-512.
+*              Cortex-M4 implementation in cbd_m4.S
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+static void cbd3(poly *r, const uint8_t buf[3*KYBER_N/4])
+{
+  cbd3_m4(r->coeffs, buf);
+}
+#elif defined(__AVX2__)
+/*************************************************
+* Name:        cbd3
+*
+* Description: Given an array of uniformly random bytes, compute
+*              polynomial with coefficients distributed according to
+*              a centered binomial distribution with parameter eta=3.
+*              This function is only needed for Kyber-512.
+*              AVX2 implementation in cbd_avx2.c
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+static void cbd3(poly *r, const uint8_t buf[3*KYBER_N/4])
+{
+  cbd3_avx2(r->coeffs, buf);
+}
+#else
+/*************************************************
+* Name:        load24_littleendian
+*
+* Description: load 3 bytes into a 32-bit integer
+*              in little-endian order.
+*              This function is only needed for Kyber-512
+*
+* Arguments:   - const uint8_t *x: pointer to input byte array
+*
+* Returns 32-bit unsigned integer loaded from x (most significant byte is zero)
+**************************************************/
+static uint32_t load24_littleendian(const uint8_t x[3])
+{
+  uint32_t r;
+  r  = (uint32_t)x[0];
+  r |= (uint32_t)x[1] << 8;
+  r |= (uint32_t)x[2] << 16;
+  return r;
+}
 
 /*************************************************
 * Name:        cbd3
@@ -85,7 +163,6 @@ static void cbd2(poly *r, const uint8_t buf[2*KYBER_N/4])
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *buf: pointer to input byte array
 **************************************************/
-#if KYBER_ETA1 == 3
 static void cbd3(poly *r, const uint8_t buf[3*KYBER_N/4])
 {
   unsigned int i,j;
@@ -106,23 +183,15 @@ static void cbd3(poly *r, const uint8_t buf[3*KYBER_N/4])
   }
 }
 #endif
+#endif
 
 void poly_cbd_eta1(poly *r, const uint8_t buf[KYBER_ETA1*KYBER_N/4])
 {
 #if KYBER_ETA1 == 2
-  cbd2(r, buf);
+  poly_cbd_eta2(r, buf);
 #elif KYBER_ETA1 == 3
   cbd3(r, buf);
 #else
 #error "This implementation requires eta1 in {2,3}"
 #endif
 }
-
-void poly_cbd_eta2(poly *r, const uint8_t buf[KYBER_ETA2*KYBER_N/4])
-{
-#if KYBER_ETA2 == 2
-  cbd2(r, buf);
-#else
-#error "This implementation requires eta2 = 2"
-#endif
-}
@@ -8,7 +8,19 @@
 #define poly_cbd_eta1 KYBER_NAMESPACE(poly_cbd_eta1)
 void poly_cbd_eta1(poly *r, const uint8_t buf[KYBER_ETA1*KYBER_N/4]);
 
-#define poly_cbd_eta2 KYBER_NAMESPACE(poly_cbd_eta2)
+#define poly_cbd_eta2 KYBER_SHARED_NAMESPACE(poly_cbd_eta2)
 void poly_cbd_eta2(poly *r, const uint8_t buf[KYBER_ETA2*KYBER_N/4]);
 
+#if defined(__ARM_FEATURE_DSP)
+#define cbd2_m4 KYBER_SHARED_NAMESPACE(cbd2_m4)
+void cbd2_m4(int16_t r[KYBER_N], const uint8_t buf[2*KYBER_N/4]);
+#define cbd3_m4 KYBER_NAMESPACE(cbd3_m4)
+void cbd3_m4(int16_t r[KYBER_N], const uint8_t buf[3*KYBER_N/4]);
+#elif defined(__AVX2__)
+#define cbd2_avx2 KYBER_SHARED_NAMESPACE(cbd2_avx2)
+void cbd2_avx2(int16_t r[KYBER_N], const uint8_t buf[2*KYBER_N/4]);
+#define cbd3_avx2 KYBER_NAMESPACE(cbd3_avx2)
+void cbd3_avx2(int16_t r[KYBER_N], const uint8_t buf[3*KYBER_N/4]);
+#endif
+
 #endif
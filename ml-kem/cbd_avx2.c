@@ -0,0 +1,94 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include "params.h"
+#include "cbd.h"
+
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
+/*************************************************
+* Name:        cbd2_avx2
+*
+* Description: AVX2 implementation of cbd2 (host only). Each byte gives
+*              two coefficients: the bit pairs are summed in place, the
+*              differences a-b+3 of both nibbles are formed at once, and
+*              the bytes are interleaved and sign-extended to 16 bits
+*
+* Arguments:   - int16_t r[KYBER_N]: output coefficients
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+void cbd2_avx2(int16_t r[KYBER_N], const uint8_t buf[2*KYBER_N/4])
+{
+  unsigned int i;
+  const __m128i mask55 = _mm_set1_epi8(0x55);
+  const __m128i mask33 = _mm_set1_epi8(0x33);
+  const __m128i mask0f = _mm_set1_epi8(0x0F);
+  const __m128i three = _mm_set1_epi8(3);
+  __m128i t, d, lo, hi;
+
+  for(i=0;i<KYBER_N/32;i++) {
+    t = _mm_loadu_si128((const __m128i *)&buf[16*i]);
+    d = _mm_add_epi8(_mm_and_si128(t, mask55), _mm_and_si128(_mm_srli_epi16(t, 1), mask55));
+    // a - b + 3 in {0,...,6} in each nibble, no borrows between nibbles
+    d = _mm_sub_epi8(_mm_add_epi8(_mm_and_si128(d, mask33), mask33),
+                     _mm_and_si128(_mm_srli_epi16(d, 2), mask33));
+    lo = _mm_and_si128(d, mask0f);
+    hi = _mm_and_si128(_mm_srli_epi16(d, 4), mask0f);
+    t = _mm_sub_epi8(_mm_unpacklo_epi8(lo, hi), three);
+    d = _mm_sub_epi8(_mm_unpackhi_epi8(lo, hi), three);
+    _mm256_storeu_si256((__m256i *)&r[32*i], _mm256_cvtepi8_epi16(t));
+    _mm256_storeu_si256((__m256i *)&r[32*i+16], _mm256_cvtepi8_epi16(d));
+  }
+}
+#endif
+
+#if KYBER_ETA1 == 3
+/*************************************************
+* Name:        cbd3_avx2
+*
+* Description: AVX2 implementation of cbd3 (host only). Eight 24-bit
+*              groups of four coefficients are spread to 32-bit lanes and
+*              processed as in the C code; the four differences of each
+*              lane are then packed to 16 bits in order.
+*              This function is only needed for Kyber-512
+*
+* Arguments:   - int16_t r[KYBER_N]: output coefficients
+*              - const uint8_t *buf: pointer to input byte array
+**************************************************/
+void cbd3_avx2(int16_t r[KYBER_N], const uint8_t buf[3*KYBER_N/4])
+{
+  unsigned int i;
+  const __m256i idx = _mm256_setr_epi8(0,1,2,-1,3,4,5,-1,6,7,8,-1,9,10,11,-1,
+                                       0,1,2,-1,3,4,5,-1,6,7,8,-1,9,10,11,-1);
+  const __m256i mask249 = _mm256_set1_epi32(0x00249249);
+  const __m256i mask7 = _mm256_set1_epi32(7);
+  const __m256i mask16 = _mm256_set1_epi32(0xFFFF);
+  __m256i t, d, c0, c1, c2, c3;
+  uint8_t b[32] = {0};
+
+  for(i=0;i<KYBER_N/32;i++) {
+    // 12 bytes per 128-bit lane; copied to avoid reading past buf
+    memcpy(&b[0], &buf[24*i], 12);
+    memcpy(&b[16], &buf[24*i+12], 12);
+    t = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)b), idx);
+
+    d = _mm256_and_si256(t, mask249);
+    d = _mm256_add_epi32(d, _mm256_and_si256(_mm256_srli_epi32(t, 1), mask249));
+    d = _mm256_add_epi32(d, _mm256_and_si256(_mm256_srli_epi32(t, 2), mask249));
+
+    c0 = _mm256_sub_epi32(_mm256_and_si256(d, mask7), _mm256_and_si256(_mm256_srli_epi32(d, 3), mask7));
+    c1 = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(d, 6), mask7), _mm256_and_si256(_mm256_srli_epi32(d, 9), mask7));
+    c2 = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(d, 12), mask7), _mm256_and_si256(_mm256_srli_epi32(d, 15), mask7));
+    c3 = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(d, 18), mask7), _mm256_and_si256(_mm256_srli_epi32(d, 21), mask7));
+
+    // (c0,c1) and (c2,c3) as 16-bit pairs, then groups 0-3 and 4-7 in order
+    c0 = _mm256_or_si256(_mm256_and_si256(c0, mask16), _mm256_slli_epi32(c1, 16));
+    c2 = _mm256_or_si256(_mm256_and_si256(c2, mask16), _mm256_slli_epi32(c3, 16));
+    c1 = _mm256_unpacklo_epi32(c0, c2);
+    c3 = _mm256_unpackhi_epi32(c0, c2);
+    _mm256_storeu_si256((__m256i *)&r[32*i], _mm256_permute2x128_si256(c1, c3, 0x20));
+    _mm256_storeu_si256((__m256i *)&r[32*i+16], _mm256_permute2x128_si256(c1, c3, 0x31));
+  }
+}
+#endif
+#endif
@@ -0,0 +1,330 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+#include "params.h"
+#include "ntt_avx2.h"
+#include "poly.h"
+
+/*
+ * AVX2 compression and decompression for ML-KEM (host only), 16
+ * coefficients at a time. The outputs are identical to the C code in
+ * poly.c, which rounds to floor((2^d*u + (q-1)/2)/q) mod 2^d.
+ */
+
+#define DV (KYBER_POLYCOMPRESSEDBYTES/32)
+#define DU (KYBER_POLYCOMPRESSEDBYTES_DU/32)
+
+/*
+ * Byte shuffles for d bits per coefficient. pack: in each 128-bit lane the
+ * bytes of the two 4d-bit quadruples (the upper one pre-shifted by 4d mod 8
+ * bits); unpack: the 3-byte windows of the even and odd coefficients of a
+ * lane and the bit offsets of the coefficients in them.
+ */
+typedef struct {
+  int8_t pack[2][16];
+  int8_t unpack[2][16];
+  int32_t shift[2][4];
+} pack_tab;
+
+#if (KYBER_POLYCOMPRESSEDBYTES == 128)
+static const pack_tab tab_dv = {
+  {{0,1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+   {-1,-1,8,9,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}},
+  {{0,1,2,-1,1,2,3,-1,2,3,4,-1,3,4,5,-1},
+   {0,1,2,-1,1,2,3,-1,2,3,4,-1,3,4,5,-1}},
+  {{0,0,0,0}, {4,4,4,4}}
+};
+#elif (KYBER_POLYCOMPRESSEDBYTES == 160)
+static const pack_tab tab_dv = {
+  {{0,1,2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+   {-1,-1,8,9,10,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1}},
+  {{0,1,2,-1,1,2,3,-1,2,3,4,-1,3,4,5,-1},
+   {0,1,2,-1,1,2,3,-1,3,4,5,-1,4,5,6,-1}},
+  {{0,2,4,6}, {5,7,1,3}}
+};
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES needs to be in {128, 160}"
+#endif
+
+#if (KYBER_POLYCOMPRESSEDBYTES_DU == 320)
+static const pack_tab tab_du = {
+  {{0,1,2,3,4,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+   {-1,-1,-1,-1,-1,8,9,10,11,12,-1,-1,-1,-1,-1,-1}},
+  {{0,1,2,-1,2,3,4,-1,5,6,7,-1,7,8,9,-1},
+   {1,2,3,-1,3,4,5,-1,6,7,8,-1,8,9,10,-1}},
+  {{0,4,0,4}, {2,6,2,6}}
+};
+#elif (KYBER_POLYCOMPRESSEDBYTES_DU == 352)
+static const pack_tab tab_du = {
+  {{0,1,2,3,4,5,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+   {-1,-1,-1,-1,-1,8,9,10,11,12,13,-1,-1,-1,-1,-1}},
+  {{0,1,2,-1,2,3,4,-1,5,6,7,-1,8,9,10,-1},
+   {1,2,3,-1,4,5,6,-1,6,7,8,-1,9,10,11,-1}},
+  {{0,6,4,2}, {3,1,7,5}}
+};
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES_DU needs to be in {320, 352}"
+#endif
+
+static __m256i load_tab(const void *p)
+{
+  return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)p));
+}
+
+/*************************************************
+* Name:        compress16
+*
+* Description: Rounds 16 coefficients in {-q+1,...,2q-1} to d bits.
+*              The quotient is estimated from the 16-bit product with
+*              round(2^26/q), which is off by at most one, and corrected
+*              with the remainder of 2^d*u + (q-1)/2
+*
+* Arguments:   - __m256i x: input coefficients
+*              - unsigned int d: number of bits, in {4, 5, 10, 11}
+*
+* Returns the compressed coefficients
+**************************************************/
+static __m256i compress16(__m256i x, unsigned int d)
+{
+  const __m256i q = _mm256_set1_epi16(KYBER_Q);
+  const __m256i v = _mm256_set1_epi16(((1<<26) + KYBER_Q/2)/KYBER_Q);
+  __m256i u, e, rem;
+
+  u = _mm256_add_epi16(x, _mm256_and_si256(_mm256_srai_epi16(x, 15), q));
+  if(d > 5) {
+    // u < q, so 8u fits; 13-d fractional bits
+    e = _mm256_mulhi_epi16(_mm256_slli_epi16(u, 3), v);
+    e = _mm256_srli_epi16(_mm256_add_epi16(e, _mm256_set1_epi16(1 << (12-d))), 13-d);
+  }
+  else {
+    // u < 2q, so 4u fits; 12-d fractional bits
+    e = _mm256_mulhi_epi16(_mm256_slli_epi16(u, 2), v);
+    e = _mm256_srli_epi16(_mm256_add_epi16(e, _mm256_set1_epi16(1 << (11-d))), 12-d);
+  }
+
+  // the remainder is in {-q,...,2q-1}, so it is exact in 16 bits
+  rem = _mm256_add_epi16(_mm256_slli_epi16(u, d), _mm256_set1_epi16(KYBER_Q/2));
+  rem = _mm256_sub_epi16(rem, _mm256_mullo_epi16(e, q));
+  e = _mm256_sub_epi16(e, _mm256_cmpgt_epi16(rem, _mm256_set1_epi16(KYBER_Q-1)));
+  e = _mm256_add_epi16(e, _mm256_cmpgt_epi16(_mm256_setzero_si256(), rem));
+  return _mm256_and_si256(e, _mm256_set1_epi16((1 << d) - 1));
+}
+
+/*************************************************
+* Name:        pack16
+*
+* Description: Serializes 16 coefficients of d bits to 2d bytes: pairs are
+*              joined with VPMADDWD, quadruples with a 64-bit shift, and
+*              the bytes of each lane are gathered with VPSHUFB
+*
+* Arguments:   - uint8_t *r: pointer to output byte array (2d bytes)
+*              - __m256i t: input coefficients
+*              - const pack_tab *tab: byte shuffles for d
+*              - unsigned int d: number of bits
+**************************************************/
+static void pack16(uint8_t *r, __m256i t, const pack_tab *tab, unsigned int d)
+{
+  __m128i lo, hi;
+
+  t = _mm256_madd_epi16(t, _mm256_set1_epi32((1 << (16+d)) | 1));
+  t = _mm256_sllv_epi32(t, _mm256_set1_epi64x(32-2*d));
+  t = _mm256_srli_epi64(t, 32-2*d);
+  t = _mm256_sllv_epi64(t, _mm256_set_epi64x((4*d)%8, 0, (4*d)%8, 0));
+  t = _mm256_or_si256(_mm256_shuffle_epi8(t, load_tab(tab->pack[0])),
+                      _mm256_shuffle_epi8(t, load_tab(tab->pack[1])));
+
+  lo = _mm256_castsi256_si128(t);
+  hi = _mm256_extracti128_si256(t, 1);
+  memcpy(r, &lo, d);
+  memcpy(r+d, &hi, d);
+}
+
+/*************************************************
+* Name:        unpack16
+*
+* Description: Deserializes and decompresses 16 coefficients of d bits;
+*              the bytes of the two halves are at b and b+16. The even and
+*              odd coefficients are extracted in 32-bit lanes and then
+*              multiplied by q with rounding (VPMULHRSW)
+*
+* Arguments:   - const uint8_t *b: pointer to input bytes
+*              - const pack_tab *tab: byte shuffles for d
+*              - unsigned int d: number of bits
+*
+* Returns the decompressed coefficients
+**************************************************/
+static __m256i unpack16(const uint8_t b[32], const pack_tab *tab, unsigned int d)
+{
+  __m256i x, e, o;
+
+  x = _mm256_loadu_si256((const __m256i *)b);
+  e = _mm256_srlv_epi32(_mm256_shuffle_epi8(x, load_tab(tab->unpack[0])), load_tab(tab->shift[0]));
+  o = _mm256_srlv_epi32(_mm256_shuffle_epi8(x, load_tab(tab->unpack[1])), load_tab(tab->shift[1]));
+  x = _mm256_blend_epi16(e, _mm256_slli_epi32(o, 16), 0xAA);
+  x = _mm256_and_si256(x, _mm256_set1_epi16((1 << d) - 1));
+
+  // (x*2^(15-d)*q + 2^14) >> 15 = (x*q + 2^(d-1)) >> d
+  return _mm256_mulhrs_epi16(_mm256_slli_epi16(x, 15-d), _mm256_set1_epi16(KYBER_Q));
+}
+
+/*************************************************
+* Name:        poly_compress_avx2
+*
+* Description: AVX2 implementation of poly_compress;
+*              coefficients have to be in {-q+1,...,2q-1}
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+void poly_compress_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const int16_t a[KYBER_N])
+{
+  unsigned int i;
+  __m256i t;
+
+  for(i=0;i<KYBER_N/16;i++) {
+    t = compress16(_mm256_loadu_si256((const __m256i *)&a[16*i]), DV);
+    pack16(&r[2*DV*i], t, &tab_dv, DV);
+  }
+}
+
+/*************************************************
+* Name:        poly_decompress_avx2
+*
+* Description: AVX2 implementation of poly_decompress
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array
+**************************************************/
+void poly_decompress_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES])
+{
+  unsigned int i;
+  uint8_t b[32] = {0};
+
+  for(i=0;i<KYBER_N/16;i++) {
+    memcpy(&b[0], &a[2*DV*i], DV);
+    memcpy(&b[16], &a[2*DV*i+DV], DV);
+    _mm256_storeu_si256((__m256i *)&r[16*i], unpack16(b, &tab_dv, DV));
+  }
+}
+
+/*************************************************
+* Name:        poly_compress_du_avx2
+*
+* Description: AVX2 implementation of poly_compress_du;
+*              coefficients have to be in {-q+1,...,q-1}
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*              - const int16_t *a: pointer to input coefficients
+**************************************************/
+void poly_compress_du_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const int16_t a[KYBER_N])
+{
+  unsigned int i;
+  __m256i t;
+
+  for(i=0;i<KYBER_N/16;i++) {
+    t = compress16(_mm256_loadu_si256((const __m256i *)&a[16*i]), DU);
+    pack16(&r[2*DU*i], t, &tab_du, DU);
+  }
+}
+
+/*************************************************
+* Name:        poly_decompress_du_avx2
+*
+* Description: AVX2 implementation of poly_decompress_du
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array
+**************************************************/
+void poly_decompress_du_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+  unsigned int i;
+  uint8_t b[32] = {0};
+
+  for(i=0;i<KYBER_N/16;i++) {
+    memcpy(&b[0], &a[2*DU*i], DU);
+    memcpy(&b[16], &a[2*DU*i+DU], DU);
+    _mm256_storeu_si256((__m256i *)&r[16*i], unpack16(b, &tab_du, DU));
+  }
+}
+
+/*************************************************
+* Name:        poly_decompress_du_ntt_avx2
+*
+* Description: poly_decompress_du_avx2 followed by ntt_avx2; the
+*              decompressed coefficients go straight into the registers
+*              of the first NTT layer
+*
+* Arguments:   - int16_t *r: pointer to output coefficients
+*              - const uint8_t *a: pointer to input byte array
+**************************************************/
+void poly_decompress_du_ntt_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+  unsigned int i;
+  uint8_t b[32] = {0};
+  __m256i v[16];
+
+  for(i=0;i<KYBER_N/16;i++) {
+    memcpy(&b[0], &a[2*DU*i], DU);
+    memcpy(&b[16], &a[2*DU*i+DU], DU);
+    v[i] = unpack16(b, &tab_du, DU);
+  }
+  ntt_avx2_regs(v);
+  for(i=0;i<KYBER_N/16;i++)
+    _mm256_storeu_si256((__m256i *)&r[16*i], v[i]);
+}
+
+/*************************************************
+* Name:        poly_invntt_add_compress_du_avx2
+*
+* Description: invntt_avx2 of a, then e is added and the sum compressed
+*              as in poly_compress_du_avx2, without storing the transform;
+*              the sum has to be in {-q+1,...,q-1}
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*              - const int16_t *a: pointer to input coefficients (NTT domain)
+*              - const int16_t *e: pointer to coefficients to add
+**************************************************/
+void poly_invntt_add_compress_du_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU],
+                                      const int16_t a[KYBER_N],
+                                      const int16_t e[KYBER_N])
+{
+  unsigned int i;
+  __m256i v[16], t;
+
+  for(i=0;i<KYBER_N/16;i++)
+    v[i] = _mm256_loadu_si256((const __m256i *)&a[16*i]);
+  invntt_avx2_regs(v);
+  for(i=0;i<KYBER_N/16;i++) {
+    t = _mm256_add_epi16(v[i], _mm256_loadu_si256((const __m256i *)&e[16*i]));
+    pack16(&r[2*DU*i], compress16(t, DU), &tab_du, DU);
+  }
+}
+
+/*************************************************
+* Name:        poly_invntt_add_compress_avx2
+*
+* Description: invntt_avx2 of a, then e is added and the sum compressed
+*              as in poly_compress_avx2, without storing the transform;
+*              the sum has to be in {-q+1,...,2q-1}
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*              - const int16_t *a: pointer to input coefficients (NTT domain)
+*              - const int16_t *e: pointer to coefficients to add
+**************************************************/
+void poly_invntt_add_compress_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES],
+                                   const int16_t a[KYBER_N],
+                                   const int16_t e[KYBER_N])
+{
+  unsigned int i;
+  __m256i v[16], t;
+
+  for(i=0;i<KYBER_N/16;i++)
+    v[i] = _mm256_loadu_si256((const __m256i *)&a[16*i]);
+  invntt_avx2_regs(v);
+  for(i=0;i<KYBER_N/16;i++) {
+    t = _mm256_add_epi16(v[i], _mm256_loadu_si256((const __m256i *)&e[16*i]));
+    pack16(&r[2*DV*i], compress16(t, DV), &tab_dv, DV);
+  }
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include <stdint.h>
+#include "params.h"
+
+/*
+ * Coefficient bound checks; compiled in with make KYBER_DEBUG=1 and empty
+ * otherwise. The bounds asserted here are the ones the reduction-free parts
+ * of the pipeline (see indcpa.c) rely on.
+ */
+#ifdef KYBER_DEBUG
+#include <assert.h>
+
+static inline int debug_check_bound(const int16_t *a, unsigned int len, int32_t lo, int32_t hi)
+{
+  unsigned int i;
+  for(i=0;i<len;i++)
+    if(a[i] < lo || a[i] >= hi)
+      return 0;
+  return 1;
+}
+
+/* Asserts lo <= a[i] < hi for all 0 <= i < len */
+#define debug_assert_bound(a, len, lo, hi) \
+  assert(debug_check_bound((a), (len), (lo), (hi)))
+
+/* Asserts |a[i]| < b for all 0 <= i < len */
+#define debug_assert_abs_bound(a, len, b) \
+  debug_assert_bound((a), (len), -(int32_t)(b) + 1, (b))
+#else
+#define debug_assert_bound(a, len, lo, hi)
+#define debug_assert_abs_bound(a, len, b)
+#endif
+
+#endif
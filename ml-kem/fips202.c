@@ -753,6 +753,52 @@ void sha3_256(uint8_t h[32], const uint8_t *in, size_t inlen)
     store64(h+8*i,s[i]);
 }
 
+/*************************************************
+* Name:        sha3_256_init
+*
+* Description: Initilizes Keccak state for use as incremental SHA3-256
+*
+* Arguments:   - keccak_state *state: pointer to (uninitialized) Keccak state
+**************************************************/
+void sha3_256_init(keccak_state *state)
+{
+  keccak_init(state->s);
+  state->pos = 0;
+}
+
+/*************************************************
+* Name:        sha3_256_absorb
+*
+* Description: Absorb step of SHA3-256; incremental.
+*
+* Arguments:   - keccak_state *state: pointer to (initialized) Keccak state
+*              - const uint8_t *in: pointer to input to be absorbed into s
+*              - size_t inlen: length of input in bytes
+**************************************************/
+void sha3_256_absorb(keccak_state *state, const uint8_t *in, size_t inlen)
+{
+  state->pos = keccak_absorb(state->s, state->pos, SHA3_256_RATE, in, inlen);
+}
+
+/*************************************************
+* Name:        sha3_256_finalize
+*
+* Description: Finalizes an incremental SHA3-256 and writes the hash;
+*              same output as sha3_256 on the concatenated input
+*
+* Arguments:   - uint8_t *h: pointer to output (32 bytes)
+*              - keccak_state *state: pointer to Keccak state
+**************************************************/
+void sha3_256_finalize(uint8_t h[32], keccak_state *state)
+{
+  unsigned int i;
+
+  keccak_finalize(state->s, state->pos, SHA3_256_RATE, 0x06);
+  KeccakF1600_StatePermute(state->s);
+  for(i=0;i<4;i++)
+    store64(h+8*i,state->s[i]);
+}
+
 /*************************************************
 * Name:        sha3_512
 *
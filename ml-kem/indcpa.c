@@ -6,9 +6,13 @@
 #include "polyvec.h"
 #include "poly.h"
 #include "ntt.h"
+#include "reduce.h"
+#include "rejsample.h"
 #include "symmetric.h"
 #include "randombytes.h"
+#include "verify.h"
 
+#if !defined(KYBER_LOWSTACK)
 /*************************************************
 * Name:        pack_pk
 *
@@ -28,6 +32,8 @@ static void pack_pk(uint8_t r[KYBER_INDCPA_PUBLICKEYBYTES],
   memcpy(r+KYBER_POLYVECBYTES, seed, KYBER_SYMBYTES);
 }
 
+#endif
+
 /*************************************************
 * Name:        unpack_pk
 *
@@ -46,6 +52,7 @@ static void unpack_pk(polyvec *pk,
   memcpy(seed, packedpk+KYBER_POLYVECBYTES, KYBER_SYMBYTES);
 }
 
+#if !defined(KYBER_LOWSTACK)
 /*************************************************
 * Name:        pack_sk
 *
@@ -72,44 +79,106 @@ static void unpack_sk(polyvec *sk, const uint8_t packedsk[KYBER_INDCPA_SECRETKEY
   polyvec_frombytes(sk, packedsk);
 }
 
+#endif
+
 /*************************************************
-* Name:        pack_ciphertext
+* Name:        compress_ciphertext
+*
+* Description: Finishes an encryption from the products in NTT domain:
+*              every b_i = invntt(b_i) + ep_i and v = invntt(v) + epp is
+*              compressed as soon as it is complete (fused on AVX2, see
+*              poly_invntt_add_compress) and either written to c or, if
+*              c is NULL, compared with the matching part of cmp in
+*              constant time
 *
-* Description: Serialize the ciphertext as concatenation of the
-*              compressed and serialized vector of polynomials b
-*              and the compressed and serialized polynomial v
+* Arguments:   - uint8_t *c: pointer to output ciphertext or NULL
+*              - const uint8_t *cmp: pointer to ciphertext to compare with
+*                                    (only used if c is NULL)
+*              - polyvec *b: pointer to the products for b in NTT domain;
+*                            its contents are undefined afterwards
+*              - poly *v: pointer to the product for v in NTT domain;
+*                         its contents are undefined afterwards
+*              - const polyvec *ep: pointer to the error vector of b
+*              - const poly *epp: pointer to the error polynomial of v
+*                                 plus the encoded message
 *
-* Arguments:   uint8_t *r: pointer to the output serialized ciphertext
-*              poly *pk: pointer to the input vector of polynomials b
-*              poly *v: pointer to the input polynomial v
+* Returns 1 if c is NULL and the ciphertext differs from cmp, 0 otherwise
 **************************************************/
-static void pack_ciphertext(uint8_t r[KYBER_INDCPA_BYTES], polyvec *b, poly *v)
+static int compress_ciphertext(uint8_t *c,
+                               const uint8_t *cmp,
+                               polyvec *b,
+                               poly *v,
+                               const polyvec *ep,
+                               const poly *epp)
 {
-  polyvec_compress(r, b);
-  poly_compress(r+KYBER_POLYVECCOMPRESSEDBYTES, v);
+  unsigned int i;
+  int fail = 0;
+  uint8_t t[KYBER_POLYCOMPRESSEDBYTES_DU];
+
+  // no reduction needed before compression: |b| < INVNTT_BOUND + eta2 < q
+  // and |v| < INVNTT_BOUND + eta2 + (q+1)/2 < 2q, see poly_compress
+  for(i=0;i<KYBER_K;i++) {
+    poly_invntt_add_compress_du(c ? c+i*KYBER_POLYCOMPRESSEDBYTES_DU : t, &b->vec[i], &ep->vec[i]);
+    if(!c)
+      fail |= verify(cmp+i*KYBER_POLYCOMPRESSEDBYTES_DU, t, KYBER_POLYCOMPRESSEDBYTES_DU);
+  }
+  poly_invntt_add_compress(c ? c+KYBER_POLYVECCOMPRESSEDBYTES : t, v, epp);
+  if(!c)
+    fail |= verify(cmp+KYBER_POLYVECCOMPRESSEDBYTES, t, KYBER_POLYCOMPRESSEDBYTES);
+  return fail;
 }
 
 /*************************************************
 * Name:        unpack_ciphertext
 *
 * Description: De-serialize and decompress ciphertext from a byte array;
-*              approximate inverse of pack_ciphertext
+*              approximate inverse of compress_ciphertext. The vector b is
+*              transformed to NTT domain right away (fused on AVX2, see
+*              poly_decompress_du_ntt)
 *
 * Arguments:   - polyvec *b: pointer to the output vector of polynomials b
+*                            (NTT domain)
 *              - poly *v: pointer to the output polynomial v
 *              - const uint8_t *c: pointer to the input serialized ciphertext
 **************************************************/
 static void unpack_ciphertext(polyvec *b, poly *v, const uint8_t c[KYBER_INDCPA_BYTES])
 {
-  polyvec_decompress(b, c);
+  polyvec_decompress_ntt(b, c);
   poly_decompress(v, c+KYBER_POLYVECCOMPRESSEDBYTES);
 }
 
+/*************************************************
+* Name:        load32_littleendian
+*
+* Description: load 4 bytes into a 32-bit integer
+*              in little-endian order
+*
+* Arguments:   - const uint8_t *x: pointer to input byte array
+*
+* Returns 32-bit unsigned integer loaded from x
+**************************************************/
+static uint32_t load32_littleendian(const uint8_t x[4])
+{
+  uint32_t r;
+  r  = (uint32_t)x[0];
+  r |= (uint32_t)x[1] << 8;
+  r |= (uint32_t)x[2] << 16;
+  r |= (uint32_t)x[3] << 24;
+  return r;
+}
+
 /*************************************************
 * Name:        rej_uniform
 *
 * Description: Run rejection sampling on uniform random bytes to generate
-*              uniform random integers mod q
+*              uniform random integers mod q.
+*              While at least 8 outputs fit, 12 bytes are loaded as three
+*              words and split into 8 candidates by shifts and masks (UBFX
+*              on Cortex-M4); every candidate is stored and the output
+*              position only advances if it is accepted, so there is no
+*              branch per candidate. The remaining outputs are sampled
+*              3 bytes at a time. With AVX2, rej_uniform_avx2 first takes
+*              16 candidates at a time.
 *
 * Arguments:   - int16_t *r: pointer to output buffer
 *              - unsigned int len: requested number of 16-bit integers (uniform mod q)
@@ -123,19 +192,45 @@ static unsigned int rej_uniform(int16_t *r,
                                 const uint8_t *buf,
                                 unsigned int buflen)
 {
-  unsigned int ctr, pos;
-  uint16_t val0, val1;
+  unsigned int ctr, pos, k;
+  uint32_t w0, w1, w2;
+  uint16_t val[8];
 
+#if defined(__AVX2__)
+  ctr = rej_uniform_avx2(r, len, buf, buflen, &pos);
+#else
   ctr = pos = 0;
+#endif
+  while(ctr + 8 <= len && pos + 12 <= buflen) {
+    w0 = load32_littleendian(buf+pos+0);
+    w1 = load32_littleendian(buf+pos+4);
+    w2 = load32_littleendian(buf+pos+8);
+    pos += 12;
+
+    val[0] = (w0 >>  0) & 0xFFF;
+    val[1] = (w0 >> 12) & 0xFFF;
+    val[2] = (w0 >> 24) | ((w1 & 0xF) << 8);
+    val[3] = (w1 >>  4) & 0xFFF;
+    val[4] = (w1 >> 16) & 0xFFF;
+    val[5] = (w1 >> 28) | ((w2 & 0xFF) << 4);
+    val[6] = (w2 >>  8) & 0xFFF;
+    val[7] = (w2 >> 20);
+
+    for(k=0;k<8;k++) {
+      r[ctr] = val[k];
+      ctr += (val[k] < KYBER_Q);
+    }
+  }
+
   while(ctr < len && pos + 3 <= buflen) {
-    val0 = ((buf[pos+0] >> 0) | ((uint16_t)buf[pos+1] << 8)) & 0xFFF;
-    val1 = ((buf[pos+1] >> 4) | ((uint16_t)buf[pos+2] << 4)) & 0xFFF;
+    val[0] = ((buf[pos+0] >> 0) | ((uint16_t)buf[pos+1] << 8)) & 0xFFF;
+    val[1] = ((buf[pos+1] >> 4) | ((uint16_t)buf[pos+2] << 4)) & 0xFFF;
     pos += 3;
 
-    if(val0 < KYBER_Q)
-      r[ctr++] = val0;
-    if(ctr < len && val1 < KYBER_Q)
-      r[ctr++] = val1;
+    if(val[0] < KYBER_Q)
+      r[ctr++] = val[0];
+    if(ctr < len && val[1] < KYBER_Q)
+      r[ctr++] = val[1];
   }
 
   return ctr;
@@ -150,7 +245,9 @@ static unsigned int rej_uniform(int16_t *r,
 * Description: Deterministically generate matrix A (or the transpose of A)
 *              from a seed. Entries of the matrix are polynomials that look
 *              uniformly random. Performs rejection sampling on output of
-*              a XOF
+*              a XOF, one block at a time: each block is squeezed into the
+*              same buffer and sampled right away, continuing where the
+*              previous block stopped
 *
 * Arguments:   - polyvec *a: pointer to ouptput matrix A
 *              - const uint8_t *seed: pointer to input seed
@@ -160,13 +257,11 @@ static unsigned int rej_uniform(int16_t *r,
 #error "Implementation of gen_matrix assumes that XOF_BLOCKBYTES is a multiple of 3"
 #endif
 
-#define GEN_MATRIX_NBLOCKS ((12*KYBER_N/8*(1 << 12)/KYBER_Q + XOF_BLOCKBYTES)/XOF_BLOCKBYTES)
 // Not static for benchmarking
 void gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed)
 {
   unsigned int ctr, i, j;
-  unsigned int buflen;
-  uint8_t buf[GEN_MATRIX_NBLOCKS*XOF_BLOCKBYTES];
+  uint8_t buf[XOF_BLOCKBYTES];
   xof_state state;
 
   for(i=0;i<KYBER_K;i++) {
@@ -176,19 +271,90 @@ void gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed)
       else
         xof_absorb(&state, seed, j, i);
 
-      xof_squeezeblocks(buf, GEN_MATRIX_NBLOCKS, &state);
-      buflen = GEN_MATRIX_NBLOCKS*XOF_BLOCKBYTES;
-      ctr = rej_uniform(a[i].vec[j].coeffs, KYBER_N, buf, buflen);
-
+      ctr = 0;
       while(ctr < KYBER_N) {
         xof_squeezeblocks(buf, 1, &state);
-        buflen = XOF_BLOCKBYTES;
-        ctr += rej_uniform(a[i].vec[j].coeffs + ctr, KYBER_N - ctr, buf, buflen);
+        ctr += rej_uniform(a[i].vec[j].coeffs + ctr, KYBER_N - ctr, buf, XOF_BLOCKBYTES);
       }
     }
   }
 }
 
+/*************************************************
+* Name:        pair_zeta
+*
+* Description: Returns the integer defining the reduction polynomial
+*              X^2 - zeta of coefficient pair p in NTT domain
+*
+* Arguments:   - unsigned int p: index of the pair (0 <= p < KYBER_N/2)
+**************************************************/
+static int16_t pair_zeta(unsigned int p)
+{
+  return (p & 1) ? -zetas[64 + p/2] : zetas[64 + p/2];
+}
+
+/*************************************************
+* Name:        basemul_acc_packed
+*
+* Description: Multiplies a coefficient pair a in NTT domain with the
+*              corresponding pair of a serialized polynomial b and adds the
+*              unreduced products to r. b[1]*zeta is computed on the fly.
+*              Requires |a| < 4096; b is in {0,...,4095} by construction
+*
+* Arguments:   - int32_t r[2]: pointer to the accumulated pair
+*              - const int16_t a[2]: pointer to the first factor
+*              - const uint8_t *b: pointer to the 3 bytes holding the second factor
+*              - int16_t zeta: integer defining the reduction polynomial
+**************************************************/
+static void basemul_acc_packed(int32_t r[2], const int16_t a[2], const uint8_t b[3], int16_t zeta)
+{
+  int16_t b0, b1, b1zeta;
+
+  b0 = ((b[0] >> 0) | ((uint16_t)b[1] << 8)) & 0xFFF;
+  b1 = ((b[1] >> 4) | ((uint16_t)b[2] << 4)) & 0xFFF;
+  b1zeta = montgomery_reduce((int32_t)b1*zeta);
+
+  r[0] += (int32_t)a[0]*b0 + (int32_t)a[1]*b1zeta;
+  r[1] += (int32_t)a[0]*b1 + (int32_t)a[1]*b0;
+}
+
+/*************************************************
+* Name:        poly_basemul_acc_packed
+*
+* Description: Multiplies a polynomial a in NTT domain with a serialized
+*              polynomial b in NTT domain and adds the unreduced result to r
+*
+* Arguments:   - int32_t *r: pointer to the accumulator (KYBER_N entries)
+*              - const poly *a: pointer to the first factor, |a| < 4096
+*              - const uint8_t *b: pointer to the serialized second factor
+*                                  (of length KYBER_POLYBYTES)
+**************************************************/
+static void poly_basemul_acc_packed(int32_t r[KYBER_N], const poly *a, const uint8_t b[KYBER_POLYBYTES])
+{
+  unsigned int p;
+
+  for(p=0;p<KYBER_N/2;p++)
+    basemul_acc_packed(&r[2*p], &a->coeffs[2*p], &b[3*p], pair_zeta(p));
+}
+
+/*************************************************
+* Name:        poly_frommont_acc
+*
+* Description: Montgomery reduces an accumulator filled by matacc or
+*              poly_basemul_acc_packed into a polynomial
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const int32_t *a: pointer to the accumulator (KYBER_N entries)
+**************************************************/
+static void poly_frommont_acc(poly *r, const int32_t a[KYBER_N])
+{
+  unsigned int k;
+
+  for(k=0;k<KYBER_N;k++)
+    r->coeffs[k] = montgomery_reduce(a[k]);
+}
+
+#if !defined(KYBER_LOWSTACK)
 /*************************************************
 * Name:        indcpa_keypair_derand
 *
@@ -212,6 +378,7 @@ void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
   const uint8_t *noiseseed = buf+KYBER_SYMBYTES;
   uint8_t nonce = 0;
   polyvec a[KYBER_K], e, pkpv, skpv;
+  polyvec_mulcache skpv_cache;
 
   memcpy(buf, coins, KYBER_SYMBYTES);
   buf[KYBER_SYMBYTES] = KYBER_K;
@@ -227,19 +394,348 @@ void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
   polyvec_ntt(&skpv);
   polyvec_ntt(&e);
 
+  // matrix-vector multiplication; the conversion out of the Montgomery
+  // domain and the addition of e are merged into the final reduction,
+  // which leaves pkpv in {-q+1,...,q-1} as required by pack_pk
+  polyvec_mulcache_compute(&skpv_cache, &skpv);
+  for(i=0;i<KYBER_K;i++)
+    polyvec_basemul_acc_add_cached(&pkpv.vec[i], &a[i], &skpv, &skpv_cache, &e.vec[i]);
+
+  pack_sk(sk, &skpv);
+  pack_pk(pk, &pkpv, publicseed);
+}
+
+/*************************************************
+* Name:        enc_compress
+*
+* Description: Encryption function of the CPA-secure public-key encryption
+*              scheme underlying Kyber; the ciphertext is either written
+*              to c or, if c is NULL, compared with cmp (see
+*              compress_ciphertext). Shared by indcpa_enc and indcpa_enc_cmp
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext or NULL
+*              - const uint8_t *cmp: pointer to ciphertext to compare with
+*                                    (only used if c is NULL)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to input random coins
+*                                      (of length KYBER_SYMBYTES)
+*
+* Returns 1 if c is NULL and the ciphertext differs from cmp, 0 otherwise
+**************************************************/
+static int enc_compress(uint8_t *c,
+                        const uint8_t *cmp,
+                        const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                        const uint8_t coins[KYBER_SYMBYTES])
+{
+  unsigned int i;
+  uint8_t seed[KYBER_SYMBYTES];
+  uint8_t nonce = 0;
+  polyvec sp, pkpv, ep, b, at[KYBER_K];
+  polyvec_mulcache sp_cache;
+  poly k, v, epp;
+
+  unpack_pk(&pkpv, seed, pk);
+  poly_frommsg(&k, m);
+  gen_at(at, seed);
+
+  for(i=0;i<KYBER_K;i++)
+    poly_getnoise_eta1(sp.vec+i, coins, nonce++);
+  for(i=0;i<KYBER_K;i++)
+    poly_getnoise_eta2(ep.vec+i, coins, nonce++);
+  poly_getnoise_eta2(&epp, coins, nonce++);
+  poly_add(&epp, &epp, &k);
+
+  polyvec_ntt(&sp);
+
   // matrix-vector multiplication
+  polyvec_mulcache_compute(&sp_cache, &sp);
+  for(i=0;i<KYBER_K;i++)
+    polyvec_basemul_acc_montgomery_cached(&b.vec[i], &at[i], &sp, &sp_cache);
+
+  polyvec_basemul_acc_montgomery_cached(&v, &pkpv, &sp, &sp_cache);
+
+  return compress_ciphertext(c, cmp, &b, &v, &ep, &epp);
+}
+
+/*************************************************
+* Name:        indcpa_enc
+*
+* Description: Encryption function of the CPA-secure
+*              public-key encryption scheme underlying Kyber.
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+**************************************************/
+void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
+                const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                const uint8_t coins[KYBER_SYMBYTES])
+{
+  enc_compress(c, NULL, m, pk, coins);
+}
+
+/*************************************************
+* Name:        indcpa_enc_cmp
+*
+* Description: Re-encryption check of the CPA-secure public-key encryption
+*              scheme underlying Kyber: encrypts m as indcpa_enc and
+*              compares the result with c in constant time, compressing
+*              one polynomial at a time instead of serializing the whole
+*              ciphertext
+*
+* Arguments:   - const uint8_t *c: pointer to ciphertext to compare with
+*                                  (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+*
+* Returns 0 if the encryption of m equals c, 1 otherwise
+**************************************************/
+int indcpa_enc_cmp(const uint8_t c[KYBER_INDCPA_BYTES],
+                   const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                   const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                   const uint8_t coins[KYBER_SYMBYTES])
+{
+  return enc_compress(NULL, c, m, pk, coins);
+}
+
+/*************************************************
+* Name:        indcpa_dec
+*
+* Description: Decryption function of the CPA-secure
+*              public-key encryption scheme underlying Kyber.
+*
+* Arguments:   - uint8_t *m: pointer to output decrypted message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const uint8_t *c: pointer to input ciphertext
+*                                  (of length KYBER_INDCPA_BYTES)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                const uint8_t c[KYBER_INDCPA_BYTES],
+                const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  polyvec b, skpv;
+  poly v, mp;
+
+  unpack_ciphertext(&b, &v, c);
+  unpack_sk(&skpv, sk);
+
+  polyvec_basemul_acc_montgomery(&mp, &skpv, &b);
+  poly_invntt_tomont(&mp);
+
+  // v is in {0,...,q-1}, so mp is in {-INVNTT_BOUND+1,...,q+INVNTT_BOUND-2},
+  // which poly_tomsg handles without prior reduction
+  poly_sub(&mp, &v, &mp);
+
+  poly_tomsg(m, &mp);
+}
+#else
+/*
+ * Low-stack variants (make KYBER_LOWSTACK=1): neither the matrix A nor any
+ * full vector of polynomials is kept in memory. Matrix entries are sampled
+ * coefficient by coefficient while the matrix-vector product consumes them,
+ * the vector operand is read from its serialized form (secret key, public
+ * key or a packed copy of sp), and every output polynomial is packed or
+ * compressed as soon as it is complete. Outputs are identical to the
+ * default implementation.
+ */
+
+/*************************************************
+* Name:        matacc
+*
+* Description: Computes row i of A*b (or A^T*b) for a serialized vector b in
+*              NTT domain without Montgomery reduction. Entries of the
+*              matrix are sampled as in gen_matrix, but one XOF block at a
+*              time, and each coefficient pair is multiplied into r as soon
+*              as it has been accepted, so the entries are never stored.
+*
+* Arguments:   - int32_t *r: pointer to the output accumulator (KYBER_N entries)
+*              - const uint8_t *b: pointer to the serialized vector
+*                                  (of length KYBER_POLYVECBYTES)
+*              - const uint8_t *seed: pointer to input seed
+*              - unsigned int i: index of the row
+*              - int transposed: boolean deciding whether A or A^T is used
+**************************************************/
+static void matacc(int32_t r[KYBER_N],
+                   const uint8_t b[KYBER_POLYVECBYTES],
+                   const uint8_t seed[KYBER_SYMBYTES],
+                   unsigned int i,
+                   int transposed)
+{
+  unsigned int ctr, pos, j, k;
+  uint16_t val[2];
+  int16_t a[2];
+  uint8_t buf[XOF_BLOCKBYTES];
+  xof_state state;
+
+  for(k=0;k<KYBER_N;k++)
+    r[k] = 0;
+
+  for(j=0;j<KYBER_K;j++) {
+    if(transposed)
+      xof_absorb(&state, seed, i, j);
+    else
+      xof_absorb(&state, seed, j, i);
+
+    ctr = 0;
+    pos = XOF_BLOCKBYTES;
+    while(ctr < KYBER_N) {
+      if(pos == XOF_BLOCKBYTES) {
+        xof_squeezeblocks(buf, 1, &state);
+        pos = 0;
+      }
+      val[0] = ((buf[pos+0] >> 0) | ((uint16_t)buf[pos+1] << 8)) & 0xFFF;
+      val[1] = ((buf[pos+1] >> 4) | ((uint16_t)buf[pos+2] << 4)) & 0xFFF;
+      pos += 3;
+
+      for(k=0;k<2 && ctr<KYBER_N;k++) {
+        if(val[k] >= KYBER_Q)
+          continue;
+        a[ctr & 1] = val[k];
+        if(ctr & 1)
+          basemul_acc_packed(&r[ctr-1], a, &b[j*KYBER_POLYBYTES + 3*(ctr/2)], pair_zeta(ctr/2));
+        ctr++;
+      }
+    }
+  }
+}
+
+/*************************************************
+* Name:        indcpa_keypair_derand
+*
+* Description: Generates public and private key for the CPA-secure
+*              public-key encryption scheme underlying Kyber
+*
+* Arguments:   - uint8_t *pk: pointer to output public key
+*                             (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
+*              - uint8_t *sk: pointer to output private key
+*                             (of length KYBER_INDCPA_SECRETKEYBYTES bytes)
+*              - const uint8_t *coins: pointer to input randomness
+*                             (of length KYBER_SYMBYTES bytes)
+**************************************************/
+void indcpa_keypair_derand(uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                           uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                           const uint8_t coins[KYBER_SYMBYTES])
+{
+  unsigned int i, k;
+  uint8_t buf[2*KYBER_SYMBYTES];
+  const uint8_t *publicseed = buf;
+  const uint8_t *noiseseed = buf+KYBER_SYMBYTES;
+  int32_t acc[KYBER_N];
+  int16_t u;
+  const int16_t f = (1ULL << 32) % KYBER_Q;
+  poly p;
+
+  memcpy(buf, coins, KYBER_SYMBYTES);
+  buf[KYBER_SYMBYTES] = KYBER_K;
+  hash_g(buf, buf, KYBER_SYMBYTES+1);
+
+  // the secret key doubles as storage for s in NTT domain
   for(i=0;i<KYBER_K;i++) {
-    polyvec_basemul_acc_montgomery(&pkpv.vec[i], &a[i], &skpv);
-    poly_tomont(&pkpv.vec[i]);
+    poly_getnoise_eta1(&p, noiseseed, i);
+    poly_ntt(&p);
+    poly_tobytes(sk+i*KYBER_POLYBYTES, &p);
   }
 
-  polyvec_add(&pkpv, &pkpv, &e);
-  polyvec_reduce(&pkpv);
+  // row i of A*s, converted to normal domain and added to e_i in one
+  // reduction as in polyvec_basemul_acc_add_cached
+  for(i=0;i<KYBER_K;i++) {
+    matacc(acc, sk, publicseed, i, 0);
+    poly_getnoise_eta1(&p, noiseseed, KYBER_K+i);
+    poly_ntt(&p);
+    for(k=0;k<KYBER_N;k++) {
+      u = montgomery_reduce(acc[k]);
+      p.coeffs[k] = montgomery_reduce((int32_t)u*f + (int32_t)p.coeffs[k]*MONT);
+    }
+    poly_tobytes(pk+i*KYBER_POLYBYTES, &p);
+  }
 
-  pack_sk(sk, &skpv);
-  pack_pk(pk, &pkpv, publicseed);
+  memcpy(pk+KYBER_POLYVECBYTES, publicseed, KYBER_SYMBYTES);
 }
 
+/*************************************************
+* Name:        enc_stream
+*
+* Description: Low-stack encryption; every polynomial of the ciphertext is
+*              compressed as soon as it is complete and either written to
+*              c or, if c is NULL, compared with the matching part of cmp
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext or NULL
+*              - const uint8_t *cmp: pointer to ciphertext to compare with
+*                                    (only used if c is NULL)
+*              - const uint8_t *m: pointer to input message
+*              - const uint8_t *pk: pointer to input public key
+*              - const uint8_t *coins: pointer to input random coins
+*
+* Returns 1 if c is NULL and the ciphertext differs from cmp, 0 otherwise
+**************************************************/
+static int enc_stream(uint8_t *c,
+                      const uint8_t *cmp,
+                      const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                      const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                      const uint8_t coins[KYBER_SYMBYTES])
+{
+  unsigned int i;
+  int fail = 0;
+  const uint8_t *seed = pk+KYBER_POLYVECBYTES;
+  uint8_t sp[KYBER_POLYVECBYTES];
+  uint8_t t[KYBER_POLYCOMPRESSEDBYTES_DU];
+  int32_t acc[KYBER_N];
+  poly b, e;
+
+  // sp in NTT domain is needed by every row, keep it serialized
+  for(i=0;i<KYBER_K;i++) {
+    poly_getnoise_eta1(&b, coins, i);
+    poly_ntt(&b);
+    poly_tobytes(sp+i*KYBER_POLYBYTES, &b);
+  }
+
+  // b_i = row i of A^T*sp plus ep_i, compressed straight into c
+  for(i=0;i<KYBER_K;i++) {
+    matacc(acc, sp, seed, i, 1);
+    poly_frommont_acc(&b, acc);
+    poly_getnoise_eta2(&e, coins, KYBER_K+i);
+    poly_invntt_add_compress_du(c ? c+i*KYBER_POLYCOMPRESSEDBYTES_DU : t, &b, &e);
+    if(!c)
+      fail |= verify(cmp+i*KYBER_POLYCOMPRESSEDBYTES_DU, t, KYBER_POLYCOMPRESSEDBYTES_DU);
+  }
+
+  // v = t^T*sp + epp + m, one polynomial of t at a time
+  for(i=0;i<KYBER_N;i++)
+    acc[i] = 0;
+  for(i=0;i<KYBER_K;i++) {
+    poly_frombytes(&e, pk+i*KYBER_POLYBYTES);
+    poly_basemul_acc_packed(acc, &e, sp+i*KYBER_POLYBYTES);
+  }
+  poly_frommont_acc(&b, acc);
+  poly_invntt_tomont(&b);
+  poly_getnoise_eta2(&e, coins, 2*KYBER_K);
+  poly_add(&b, &b, &e);
+  poly_frommsg(&e, m);
+  poly_add(&b, &b, &e);
+  if(c)
+    poly_compress(c+KYBER_POLYVECCOMPRESSEDBYTES, &b);
+  else
+    fail |= poly_compress_cmp(cmp+KYBER_POLYVECCOMPRESSEDBYTES, &b);
+  return fail;
+}
 
 /*************************************************
 * Name:        indcpa_enc
@@ -261,72 +757,297 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
                 const uint8_t m[KYBER_INDCPA_MSGBYTES],
                 const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                 const uint8_t coins[KYBER_SYMBYTES])
+{
+  enc_stream(c, NULL, m, pk, coins);
+}
+
+/*************************************************
+* Name:        indcpa_enc_cmp
+*
+* Description: Re-encryption check of the CPA-secure public-key encryption
+*              scheme underlying Kyber: encrypts m as indcpa_enc and
+*              compares every compressed polynomial with the matching part
+*              of c in constant time as soon as it is complete
+*
+* Arguments:   - const uint8_t *c: pointer to ciphertext to compare with
+*                                  (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+*
+* Returns 0 if the encryption of m equals c, 1 otherwise
+**************************************************/
+int indcpa_enc_cmp(const uint8_t c[KYBER_INDCPA_BYTES],
+                   const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                   const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                   const uint8_t coins[KYBER_SYMBYTES])
+{
+  return enc_stream(NULL, c, m, pk, coins);
+}
+
+/*************************************************
+* Name:        indcpa_dec
+*
+* Description: Decryption function of the CPA-secure
+*              public-key encryption scheme underlying Kyber.
+*
+* Arguments:   - uint8_t *m: pointer to output decrypted message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const uint8_t *c: pointer to input ciphertext
+*                                  (of length KYBER_INDCPA_BYTES)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                const uint8_t c[KYBER_INDCPA_BYTES],
+                const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  unsigned int i;
+  int32_t acc[KYBER_N];
+
+  for(i=0;i<KYBER_N;i++)
+    acc[i] = 0;
+  for(i=0;i<KYBER_K;i++)
+    indcpa_dec_update(acc, c+i*KYBER_POLYCOMPRESSEDBYTES_DU, sk, i);
+  indcpa_dec_final(m, acc, c+KYBER_POLYVECCOMPRESSEDBYTES);
+}
+#endif
+
+/*************************************************
+* Name:        indcpa_enc_prepare
+*
+* Description: Expands a public key for repeated encryption: unpacks t,
+*              generates A^T and precomputes the base multiplication
+*              caches of both, so that indcpa_enc_prepared only does the
+*              per-message work
+*
+* Arguments:   - indcpa_enc_ctx *ctx: pointer to output context
+*              - const uint8_t *pk: pointer to input public key
+*                                   (of length KYBER_INDCPA_PUBLICKEYBYTES)
+**************************************************/
+void indcpa_enc_prepare(indcpa_enc_ctx *ctx,
+                        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES])
 {
   unsigned int i;
   uint8_t seed[KYBER_SYMBYTES];
+
+  unpack_pk(&ctx->pkpv, seed, pk);
+  gen_at(ctx->at, seed);
+
+  // t and A^T are the cached operands of the products in indcpa_enc_prepared,
+  // which requires them to be below q
+  polyvec_reduce(&ctx->pkpv);
+  polyvec_mulcache_compute(&ctx->pkpv_cache, &ctx->pkpv);
+  for(i=0;i<KYBER_K;i++)
+    polyvec_mulcache_compute(&ctx->at_cache[i], &ctx->at[i]);
+}
+
+/*************************************************
+* Name:        enc_prepared_compress
+*
+* Description: Encryption for a public key expanded by indcpa_enc_prepare;
+*              the ciphertext is either written to c or, if c is NULL,
+*              compared with cmp (see compress_ciphertext). Shared by
+*              indcpa_enc_prepared and indcpa_enc_prepared_cmp
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext or NULL
+*              - const uint8_t *cmp: pointer to ciphertext to compare with
+*                                    (only used if c is NULL)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const indcpa_enc_ctx *ctx: pointer to input context
+*              - const uint8_t *coins: pointer to input random coins
+*                                      (of length KYBER_SYMBYTES)
+*
+* Returns 1 if c is NULL and the ciphertext differs from cmp, 0 otherwise
+**************************************************/
+static int enc_prepared_compress(uint8_t *c,
+                                 const uint8_t *cmp,
+                                 const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                                 const indcpa_enc_ctx *ctx,
+                                 const uint8_t coins[KYBER_SYMBYTES])
+{
+  unsigned int i;
   uint8_t nonce = 0;
-  polyvec sp, pkpv, ep, at[KYBER_K], b;
-  poly v, k, epp;
+  polyvec sp, ep, b;
+  poly k, v, epp;
 
-  unpack_pk(&pkpv, seed, pk);
   poly_frommsg(&k, m);
-  gen_at(at, seed);
 
   for(i=0;i<KYBER_K;i++)
     poly_getnoise_eta1(sp.vec+i, coins, nonce++);
   for(i=0;i<KYBER_K;i++)
     poly_getnoise_eta2(ep.vec+i, coins, nonce++);
   poly_getnoise_eta2(&epp, coins, nonce++);
+  poly_add(&epp, &epp, &k);
 
   polyvec_ntt(&sp);
 
-  // matrix-vector multiplication
+  // matrix-vector multiplication; sp is the uncached operand, the
+  // caches of A^T and t come from ctx
   for(i=0;i<KYBER_K;i++)
-    polyvec_basemul_acc_montgomery(&b.vec[i], &at[i], &sp);
+    polyvec_basemul_acc_montgomery_cached(&b.vec[i], &sp, &ctx->at[i], &ctx->at_cache[i]);
 
-  polyvec_basemul_acc_montgomery(&v, &pkpv, &sp);
+  polyvec_basemul_acc_montgomery_cached(&v, &sp, &ctx->pkpv, &ctx->pkpv_cache);
 
-  polyvec_invntt_tomont(&b);
-  poly_invntt_tomont(&v);
+  return compress_ciphertext(c, cmp, &b, &v, &ep, &epp);
+}
+
+/*************************************************
+* Name:        indcpa_enc_prepared
+*
+* Description: Encryption function of the CPA-secure public-key encryption
+*              scheme underlying Kyber for a public key expanded by
+*              indcpa_enc_prepare; same output as indcpa_enc
+*
+* Arguments:   - uint8_t *c: pointer to output ciphertext
+*                            (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const indcpa_enc_ctx *ctx: pointer to input context
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+**************************************************/
+void indcpa_enc_prepared(uint8_t c[KYBER_INDCPA_BYTES],
+                         const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                         const indcpa_enc_ctx *ctx,
+                         const uint8_t coins[KYBER_SYMBYTES])
+{
+  enc_prepared_compress(c, NULL, m, ctx, coins);
+}
 
-  polyvec_add(&b, &b, &ep);
-  poly_add(&v, &v, &epp);
-  poly_add(&v, &v, &k);
-  polyvec_reduce(&b);
-  poly_reduce(&v);
+/*************************************************
+* Name:        indcpa_enc_prepared_cmp
+*
+* Description: Re-encryption check as indcpa_enc_cmp for a public key
+*              expanded by indcpa_enc_prepare
+*
+* Arguments:   - const uint8_t *c: pointer to ciphertext to compare with
+*                                  (of length KYBER_INDCPA_BYTES bytes)
+*              - const uint8_t *m: pointer to input message
+*                                  (of length KYBER_INDCPA_MSGBYTES bytes)
+*              - const indcpa_enc_ctx *ctx: pointer to input context
+*              - const uint8_t *coins: pointer to input random coins used as seed
+*                                      (of length KYBER_SYMBYTES) to deterministically
+*                                      generate all randomness
+*
+* Returns 0 if the encryption of m equals c, 1 otherwise
+**************************************************/
+int indcpa_enc_prepared_cmp(const uint8_t c[KYBER_INDCPA_BYTES],
+                            const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                            const indcpa_enc_ctx *ctx,
+                            const uint8_t coins[KYBER_SYMBYTES])
+{
+  return enc_prepared_compress(NULL, c, m, ctx, coins);
+}
 
-  pack_ciphertext(c, &b, &v);
+/*************************************************
+* Name:        indcpa_dec_prepare
+*
+* Description: Expands a secret key for repeated decryption: unpacks s
+*              and precomputes its base multiplication cache
+*
+* Arguments:   - indcpa_dec_ctx *ctx: pointer to output context
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+**************************************************/
+void indcpa_dec_prepare(indcpa_dec_ctx *ctx,
+                        const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+{
+  polyvec_frombytes(&ctx->skpv, sk);
+  // s is the cached operand in indcpa_dec_prepared, which requires |s| < q
+  polyvec_reduce(&ctx->skpv);
+  polyvec_mulcache_compute(&ctx->skpv_cache, &ctx->skpv);
 }
 
 /*************************************************
-* Name:        indcpa_dec
+* Name:        indcpa_dec_prepared
 *
-* Description: Decryption function of the CPA-secure
-*              public-key encryption scheme underlying Kyber.
+* Description: Decryption function of the CPA-secure public-key encryption
+*              scheme underlying Kyber for a secret key expanded by
+*              indcpa_dec_prepare; same output as indcpa_dec
 *
 * Arguments:   - uint8_t *m: pointer to output decrypted message
 *                            (of length KYBER_INDCPA_MSGBYTES)
 *              - const uint8_t *c: pointer to input ciphertext
 *                                  (of length KYBER_INDCPA_BYTES)
-*              - const uint8_t *sk: pointer to input secret key
-*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+*              - const indcpa_dec_ctx *ctx: pointer to input context
 **************************************************/
-void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
-                const uint8_t c[KYBER_INDCPA_BYTES],
-                const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES])
+void indcpa_dec_prepared(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                         const uint8_t c[KYBER_INDCPA_BYTES],
+                         const indcpa_dec_ctx *ctx)
 {
-  polyvec b, skpv;
+  polyvec b;
   poly v, mp;
 
   unpack_ciphertext(&b, &v, c);
-  unpack_sk(&skpv, sk);
 
-  polyvec_ntt(&b);
-  polyvec_basemul_acc_montgomery(&mp, &skpv, &b);
+  polyvec_basemul_acc_montgomery_cached(&mp, &b, &ctx->skpv, &ctx->skpv_cache);
   poly_invntt_tomont(&mp);
 
+  // bounds as in indcpa_dec
   poly_sub(&mp, &v, &mp);
-  poly_reduce(&mp);
 
   poly_tomsg(m, &mp);
 }
+
+/*************************************************
+* Name:        indcpa_dec_update
+*
+* Description: Incremental decryption: decompresses polynomial i of the
+*              ciphertext vector u, transforms it to NTT domain and adds
+*              its product with s_i to the accumulator, so that every
+*              polynomial can be processed as soon as its bytes are known
+*
+* Arguments:   - int32_t *acc: pointer to the accumulator (KYBER_N entries,
+*                              zero before the first call)
+*              - const uint8_t *c: pointer to compressed polynomial i of u
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES_DU)
+*              - const uint8_t *sk: pointer to input secret key
+*                                   (of length KYBER_INDCPA_SECRETKEYBYTES)
+*              - unsigned int i: index of the polynomial
+**************************************************/
+void indcpa_dec_update(int32_t acc[KYBER_N],
+                       const uint8_t c[KYBER_POLYCOMPRESSEDBYTES_DU],
+                       const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                       unsigned int i)
+{
+  poly b;
+
+  poly_decompress_du_ntt(&b, c);
+  poly_basemul_acc_packed(acc, &b, sk+i*KYBER_POLYBYTES);
+}
+
+/*************************************************
+* Name:        indcpa_dec_final
+*
+* Description: Finishes an incremental decryption once all KYBER_K
+*              polynomials of u have been added by indcpa_dec_update;
+*              same output as indcpa_dec
+*
+* Arguments:   - uint8_t *m: pointer to output decrypted message
+*                            (of length KYBER_INDCPA_MSGBYTES)
+*              - const int32_t *acc: pointer to the accumulator
+*              - const uint8_t *c: pointer to the compressed polynomial v
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES)
+**************************************************/
+void indcpa_dec_final(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                      const int32_t acc[KYBER_N],
+                      const uint8_t c[KYBER_POLYCOMPRESSEDBYTES])
+{
+  poly b, v;
+
+  poly_frommont_acc(&b, acc);
+  poly_invntt_tomont(&b);
+
+  // bounds as in indcpa_dec
+  poly_decompress(&v, c);
+  poly_sub(&b, &v, &b);
+
+  poly_tomsg(m, &b);
+}
@@ -5,6 +5,24 @@
 #include "params.h"
 #include "polyvec.h"
 
+/*
+ * Public key expanded for repeated encryption, see indcpa_enc_prepare
+ */
+typedef struct{
+  polyvec at[KYBER_K];
+  polyvec_mulcache at_cache[KYBER_K];
+  polyvec pkpv;
+  polyvec_mulcache pkpv_cache;
+} indcpa_enc_ctx;
+
+/*
+ * Secret key expanded for repeated decryption, see indcpa_dec_prepare
+ */
+typedef struct{
+  polyvec skpv;
+  polyvec_mulcache skpv_cache;
+} indcpa_dec_ctx;
+
 #define gen_matrix KYBER_NAMESPACE(gen_matrix)
 void gen_matrix(polyvec *a, const uint8_t seed[KYBER_SYMBYTES], int transposed);
 
@@ -19,9 +37,51 @@ void indcpa_enc(uint8_t c[KYBER_INDCPA_BYTES],
                 const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
                 const uint8_t coins[KYBER_SYMBYTES]);
 
+#define indcpa_enc_cmp KYBER_NAMESPACE(indcpa_enc_cmp)
+int indcpa_enc_cmp(const uint8_t c[KYBER_INDCPA_BYTES],
+                   const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                   const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES],
+                   const uint8_t coins[KYBER_SYMBYTES]);
+
+#define indcpa_enc_prepare KYBER_NAMESPACE(indcpa_enc_prepare)
+void indcpa_enc_prepare(indcpa_enc_ctx *ctx,
+                        const uint8_t pk[KYBER_INDCPA_PUBLICKEYBYTES]);
+
+#define indcpa_enc_prepared KYBER_NAMESPACE(indcpa_enc_prepared)
+void indcpa_enc_prepared(uint8_t c[KYBER_INDCPA_BYTES],
+                         const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                         const indcpa_enc_ctx *ctx,
+                         const uint8_t coins[KYBER_SYMBYTES]);
+
+#define indcpa_enc_prepared_cmp KYBER_NAMESPACE(indcpa_enc_prepared_cmp)
+int indcpa_enc_prepared_cmp(const uint8_t c[KYBER_INDCPA_BYTES],
+                            const uint8_t m[KYBER_INDCPA_MSGBYTES],
+                            const indcpa_enc_ctx *ctx,
+                            const uint8_t coins[KYBER_SYMBYTES]);
+
 #define indcpa_dec KYBER_NAMESPACE(indcpa_dec)
 void indcpa_dec(uint8_t m[KYBER_INDCPA_MSGBYTES],
                 const uint8_t c[KYBER_INDCPA_BYTES],
                 const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
 
+#define indcpa_dec_update KYBER_NAMESPACE(indcpa_dec_update)
+void indcpa_dec_update(int32_t acc[KYBER_N],
+                       const uint8_t c[KYBER_POLYCOMPRESSEDBYTES_DU],
+                       const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES],
+                       unsigned int i);
+
+#define indcpa_dec_final KYBER_NAMESPACE(indcpa_dec_final)
+void indcpa_dec_final(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                      const int32_t acc[KYBER_N],
+                      const uint8_t c[KYBER_POLYCOMPRESSEDBYTES]);
+
+#define indcpa_dec_prepare KYBER_NAMESPACE(indcpa_dec_prepare)
+void indcpa_dec_prepare(indcpa_dec_ctx *ctx,
+                        const uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES]);
+
+#define indcpa_dec_prepared KYBER_NAMESPACE(indcpa_dec_prepared)
+void indcpa_dec_prepared(uint8_t m[KYBER_INDCPA_MSGBYTES],
+                         const uint8_t c[KYBER_INDCPA_BYTES],
+                         const indcpa_dec_ctx *ctx);
+
 #endif
@@ -3,6 +3,9 @@
 #include <string.h>
 #include "params.h"
 #include "kem.h"
+#include "kem_prepared.h"
+#include "kem_seed.h"
+#include "kem_stream.h"
 #include "indcpa.h"
 #include "verify.h"
 #include "symmetric.h"
@@ -120,6 +123,90 @@ int crypto_kem_enc(uint8_t *ct,
   return 0;
 }
 
+/*************************************************
+* Name:        crypto_kem_enc_prepare
+*
+* Description: Expands a public key for repeated encapsulation: caches
+*              H(pk), the unpacked public key and the matrix A^T so that
+*              crypto_kem_enc_prepared only does the per-message work
+*
+* Arguments:   - crypto_kem_enc_ctx *ctx: pointer to output context
+*              - const uint8_t *pk: pointer to input public key
+*                (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_prepare(crypto_kem_enc_ctx *ctx,
+                           const uint8_t *pk)
+{
+  indcpa_enc_prepare(&ctx->indcpa, pk);
+  hash_h(ctx->hpk, pk, KYBER_PUBLICKEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_prepared_derand
+*
+* Description: Generates cipher text and shared secret for a public key
+*              expanded by crypto_kem_enc_prepare; same output as
+*              crypto_kem_enc_derand
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const crypto_kem_enc_ctx *ctx: pointer to input context
+*              - const uint8_t *coins: pointer to input randomness
+*                (an already allocated array filled with KYBER_SYMBYTES random bytes)
+**
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_prepared_derand(uint8_t *ct,
+                                   uint8_t *ss,
+                                   const crypto_kem_enc_ctx *ctx,
+                                   const uint8_t *coins)
+{
+  uint8_t buf[2*KYBER_SYMBYTES];
+  /* Will contain key, coins */
+  uint8_t kr[2*KYBER_SYMBYTES];
+
+  memcpy(buf, coins, KYBER_SYMBYTES);
+
+  /* Multitarget countermeasure for coins + contributory KEM */
+  memcpy(buf+KYBER_SYMBYTES, ctx->hpk, KYBER_SYMBYTES);
+  hash_g(kr, buf, 2*KYBER_SYMBYTES);
+
+  /* coins are in kr+KYBER_SYMBYTES */
+  indcpa_enc_prepared(ct, buf, &ctx->indcpa, kr+KYBER_SYMBYTES);
+
+  memcpy(ss,kr,KYBER_SYMBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_prepared
+*
+* Description: Generates cipher text and shared secret for a public key
+*              expanded by crypto_kem_enc_prepare
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const crypto_kem_enc_ctx *ctx: pointer to input context
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_prepared(uint8_t *ct,
+                            uint8_t *ss,
+                            const crypto_kem_enc_ctx *ctx)
+{
+  uint8_t coins[KYBER_SYMBYTES];
+  randombytes(coins, KYBER_SYMBYTES);
+  crypto_kem_enc_prepared_derand(ct, ss, ctx, coins);
+  return 0;
+}
+
 /*************************************************
 * Name:        crypto_kem_dec
 *
@@ -145,8 +232,6 @@ int crypto_kem_dec(uint8_t *ss,
   uint8_t buf[2*KYBER_SYMBYTES];
   /* Will contain key, coins */
   uint8_t kr[2*KYBER_SYMBYTES];
-//  uint8_t cmp[KYBER_CIPHERTEXTBYTES+KYBER_SYMBYTES];
-  uint8_t cmp[KYBER_CIPHERTEXTBYTES];
   const uint8_t *pk = sk+KYBER_INDCPA_SECRETKEYBYTES;
 
   indcpa_dec(buf, ct, sk);
@@ -155,10 +240,9 @@ int crypto_kem_dec(uint8_t *ss,
   memcpy(buf+KYBER_SYMBYTES, sk+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, KYBER_SYMBYTES);
   hash_g(kr, buf, 2*KYBER_SYMBYTES);
 
-  /* coins are in kr+KYBER_SYMBYTES */
-  indcpa_enc(cmp, buf, pk, kr+KYBER_SYMBYTES);
-
-  fail = verify(ct, cmp, KYBER_CIPHERTEXTBYTES);
+  /* coins are in kr+KYBER_SYMBYTES; the re-encryption is compared with
+     ct polynomial by polynomial, without a second ciphertext buffer */
+  fail = indcpa_enc_cmp(ct, buf, pk, kr+KYBER_SYMBYTES);
 
   /* Compute rejection key */
   rkprf(ss,sk+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES,ct);
@@ -168,3 +252,410 @@ int crypto_kem_dec(uint8_t *ss,
 
   return 0;
 }
+
+/*************************************************
+* Name:        crypto_kem_dec_prepare
+*
+* Description: Expands a secret key for repeated decapsulation: caches the
+*              unpacked secret vector, the expanded public key used for the
+*              re-encryption (see crypto_kem_enc_prepare), H(pk) and the
+*              rejection value z
+*
+* Arguments:   - crypto_kem_dec_ctx *ctx: pointer to output context
+*              - const uint8_t *sk: pointer to input private key
+*                (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_dec_prepare(crypto_kem_dec_ctx *ctx,
+                           const uint8_t *sk)
+{
+  indcpa_dec_prepare(&ctx->indcpa_dec, sk);
+  indcpa_enc_prepare(&ctx->indcpa_enc, sk+KYBER_INDCPA_SECRETKEYBYTES);
+  memcpy(ctx->hpk, sk+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, KYBER_SYMBYTES);
+  memcpy(ctx->z, sk+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES, KYBER_SYMBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_prepared
+*
+* Description: Generates shared secret for given cipher text and a
+*              private key expanded by crypto_kem_dec_prepare; same
+*              output as crypto_kem_dec, including implicit rejection
+*
+* Arguments:   - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *ct: pointer to input cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - const crypto_kem_dec_ctx *ctx: pointer to input context
+*
+* Returns 0.
+*
+* On failure, ss will contain a pseudo-random value.
+**************************************************/
+int crypto_kem_dec_prepared(uint8_t *ss,
+                            const uint8_t *ct,
+                            const crypto_kem_dec_ctx *ctx)
+{
+  int fail;
+  uint8_t buf[2*KYBER_SYMBYTES];
+  /* Will contain key, coins */
+  uint8_t kr[2*KYBER_SYMBYTES];
+
+  indcpa_dec_prepared(buf, ct, &ctx->indcpa_dec);
+
+  /* Multitarget countermeasure for coins + contributory KEM */
+  memcpy(buf+KYBER_SYMBYTES, ctx->hpk, KYBER_SYMBYTES);
+  hash_g(kr, buf, 2*KYBER_SYMBYTES);
+
+  /* coins are in kr+KYBER_SYMBYTES */
+  fail = indcpa_enc_prepared_cmp(ct, buf, &ctx->indcpa_enc, kr+KYBER_SYMBYTES);
+
+  /* Compute rejection key */
+  rkprf(ss,ctx->z,ct);
+
+  /* Copy true key to return buffer if fail is false */
+  cmov(ss,kr,KYBER_SYMBYTES,!fail);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_keypair_seed_derand
+*
+* Description: Generates public key and seed-format private key; the
+*              private key is the seed (d, z) itself, the public key is
+*              the one crypto_kem_keypair_derand derives from it
+*
+* Arguments:   - uint8_t *pk: pointer to output public key
+*                (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+*              - uint8_t *seed: pointer to output private key
+*                (an already allocated array of KYBER_SEEDKEYBYTES bytes)
+*              - uint8_t *coins: pointer to input randomness
+*                (an already allocated array filled with 2*KYBER_SYMBYTES random bytes)
+**
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_keypair_seed_derand(uint8_t *pk,
+                                   uint8_t *seed,
+                                   const uint8_t *coins)
+{
+  uint8_t sk[KYBER_INDCPA_SECRETKEYBYTES];
+
+  indcpa_keypair_derand(pk, sk, coins);
+  memmove(seed, coins, KYBER_SEEDKEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_keypair_seed
+*
+* Description: Generates public key and seed-format private key
+*
+* Arguments:   - uint8_t *pk: pointer to output public key
+*                (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+*              - uint8_t *seed: pointer to output private key
+*                (an already allocated array of KYBER_SEEDKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_keypair_seed(uint8_t *pk,
+                            uint8_t *seed)
+{
+  randombytes(seed, KYBER_SEEDKEYBYTES);
+  crypto_kem_keypair_seed_derand(pk, seed, seed);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_seed_expand
+*
+* Description: Regenerates the expanded private key of a seed-format
+*              private key; the public key is part of it, at offset
+*              KYBER_INDCPA_SECRETKEYBYTES
+*
+* Arguments:   - uint8_t *sk: pointer to output private key
+*                (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+*              - const uint8_t *seed: pointer to input private key
+*                (an already allocated array of KYBER_SEEDKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_seed_expand(uint8_t *sk,
+                           const uint8_t *seed)
+{
+  /* the public key is generated in place, as part of the private key */
+  uint8_t *pk = sk+KYBER_INDCPA_SECRETKEYBYTES;
+
+  indcpa_keypair_derand(pk, sk, seed);
+  hash_h(sk+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);
+  memcpy(sk+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES, seed+KYBER_SYMBYTES, KYBER_SYMBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_seed
+*
+* Description: Generates shared secret for given cipher text and
+*              seed-format private key; expands the key on the stack and
+*              gives the same output as crypto_kem_dec on the expanded key
+*
+* Arguments:   - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - const uint8_t *ct: pointer to input cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - const uint8_t *seed: pointer to input private key
+*                (an already allocated array of KYBER_SEEDKEYBYTES bytes)
+*
+* Returns 0.
+*
+* On failure, ss will contain a pseudo-random value.
+**************************************************/
+int crypto_kem_dec_seed(uint8_t *ss,
+                        const uint8_t *ct,
+                        const uint8_t *seed)
+{
+  uint8_t sk[KYBER_SECRETKEYBYTES];
+
+  crypto_kem_seed_expand(sk, seed);
+  return crypto_kem_dec(ss, ct, sk);
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_prepare_seed
+*
+* Description: Expands a seed-format private key for repeated
+*              decapsulation with crypto_kem_dec_prepared
+*
+* Arguments:   - crypto_kem_dec_ctx *ctx: pointer to output context
+*              - const uint8_t *seed: pointer to input private key
+*                (an already allocated array of KYBER_SEEDKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_dec_prepare_seed(crypto_kem_dec_ctx *ctx,
+                                const uint8_t *seed)
+{
+  uint8_t sk[KYBER_SECRETKEYBYTES];
+
+  crypto_kem_seed_expand(sk, seed);
+  return crypto_kem_dec_prepare(ctx, sk);
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_init
+*
+* Description: Starts an incremental encapsulation for a public key that
+*              is passed in chunks to crypto_kem_enc_update. H(pk) is
+*              computed while the chunks arrive; A is generated from the
+*              seed at the end of pk and the coins depend on H(pk), so the
+*              rest of the work is done by crypto_kem_enc_final
+*
+* Arguments:   - crypto_kem_enc_stream_ctx *ctx: pointer to output context
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_init(crypto_kem_enc_stream_ctx *ctx)
+{
+  hash_h_init(&ctx->hpk);
+  ctx->len = 0;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_update
+*
+* Description: Passes the next chunk of the public key to an incremental
+*              encapsulation
+*
+* Arguments:   - crypto_kem_enc_stream_ctx *ctx: pointer to context
+*              - const uint8_t *in: pointer to the chunk
+*              - size_t inlen: length of the chunk in bytes
+*
+* Returns 0 (success) or -1 if the chunks exceed KYBER_PUBLICKEYBYTES
+**************************************************/
+int crypto_kem_enc_update(crypto_kem_enc_stream_ctx *ctx,
+                          const uint8_t *in,
+                          size_t inlen)
+{
+  if(inlen > KYBER_PUBLICKEYBYTES - ctx->len)
+    return -1;
+
+  memcpy(ctx->pk+ctx->len, in, inlen);
+  ctx->len += inlen;
+  hash_h_absorb(&ctx->hpk, in, inlen);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_final_derand
+*
+* Description: Finishes an incremental encapsulation; same output as
+*              crypto_kem_enc_derand on the concatenated chunks
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - crypto_kem_enc_stream_ctx *ctx: pointer to context
+*              - const uint8_t *coins: pointer to input randomness
+*                (an already allocated array filled with KYBER_SYMBYTES random bytes)
+**
+* Returns 0 (success) or -1 if the public key is incomplete
+**************************************************/
+int crypto_kem_enc_final_derand(uint8_t *ct,
+                                uint8_t *ss,
+                                crypto_kem_enc_stream_ctx *ctx,
+                                const uint8_t *coins)
+{
+  uint8_t buf[2*KYBER_SYMBYTES];
+  /* Will contain key, coins */
+  uint8_t kr[2*KYBER_SYMBYTES];
+
+  if(ctx->len != KYBER_PUBLICKEYBYTES)
+    return -1;
+
+  memcpy(buf, coins, KYBER_SYMBYTES);
+
+  /* Multitarget countermeasure for coins + contributory KEM */
+  hash_h_finalize(buf+KYBER_SYMBYTES, &ctx->hpk);
+  hash_g(kr, buf, 2*KYBER_SYMBYTES);
+
+  /* coins are in kr+KYBER_SYMBYTES */
+  indcpa_enc(ct, buf, ctx->pk, kr+KYBER_SYMBYTES);
+
+  memcpy(ss,kr,KYBER_SYMBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_final
+*
+* Description: Finishes an incremental encapsulation
+*
+* Arguments:   - uint8_t *ct: pointer to output cipher text
+*                (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - crypto_kem_enc_stream_ctx *ctx: pointer to context
+*
+* Returns 0 (success) or -1 if the public key is incomplete
+**************************************************/
+int crypto_kem_enc_final(uint8_t *ct,
+                         uint8_t *ss,
+                         crypto_kem_enc_stream_ctx *ctx)
+{
+  uint8_t coins[KYBER_SYMBYTES];
+  randombytes(coins, KYBER_SYMBYTES);
+  return crypto_kem_enc_final_derand(ct, ss, ctx, coins);
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_init
+*
+* Description: Starts an incremental decapsulation for a cipher text that
+*              is passed in chunks to crypto_kem_dec_update. Every
+*              polynomial of u is decompressed, transformed and multiplied
+*              with s as soon as its bytes are complete, and the chunks
+*              are absorbed into the rejection key PRF right away
+*
+* Arguments:   - crypto_kem_dec_stream_ctx *ctx: pointer to output context
+*              - const uint8_t *sk: pointer to input private key, which has
+*                to stay valid until crypto_kem_dec_final
+*                (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_dec_init(crypto_kem_dec_stream_ctx *ctx,
+                        const uint8_t *sk)
+{
+  unsigned int i;
+
+  ctx->sk = sk;
+  rkprf_init(&ctx->rk, sk+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES);
+  for(i=0;i<KYBER_N;i++)
+    ctx->acc[i] = 0;
+  ctx->len = 0;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_update
+*
+* Description: Passes the next chunk of the cipher text to an incremental
+*              decapsulation
+*
+* Arguments:   - crypto_kem_dec_stream_ctx *ctx: pointer to context
+*              - const uint8_t *in: pointer to the chunk
+*              - size_t inlen: length of the chunk in bytes
+*
+* Returns 0 (success) or -1 if the chunks exceed KYBER_CIPHERTEXTBYTES
+**************************************************/
+int crypto_kem_dec_update(crypto_kem_dec_stream_ctx *ctx,
+                          const uint8_t *in,
+                          size_t inlen)
+{
+  size_t i, done, avail;
+
+  if(inlen > KYBER_CIPHERTEXTBYTES - ctx->len)
+    return -1;
+
+  done = ctx->len/KYBER_POLYCOMPRESSEDBYTES_DU;
+  memcpy(ctx->ct+ctx->len, in, inlen);
+  ctx->len += inlen;
+  rkprf_absorb(&ctx->rk, in, inlen);
+
+  avail = ctx->len/KYBER_POLYCOMPRESSEDBYTES_DU;
+  if(avail > KYBER_K)
+    avail = KYBER_K;
+  for(i=done;i<avail;i++)
+    indcpa_dec_update(ctx->acc, ctx->ct+i*KYBER_POLYCOMPRESSEDBYTES_DU, ctx->sk, i);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_final
+*
+* Description: Finishes an incremental decapsulation; same output as
+*              crypto_kem_dec on the concatenated chunks, including
+*              implicit rejection
+*
+* Arguments:   - uint8_t *ss: pointer to output shared secret
+*                (an already allocated array of KYBER_SSBYTES bytes)
+*              - crypto_kem_dec_stream_ctx *ctx: pointer to context
+*
+* Returns 0 or -1 if the cipher text is incomplete.
+*
+* On failure of the re-encryption check, ss will contain a pseudo-random value.
+**************************************************/
+int crypto_kem_dec_final(uint8_t *ss,
+                         crypto_kem_dec_stream_ctx *ctx)
+{
+  int fail;
+  uint8_t buf[2*KYBER_SYMBYTES];
+  /* Will contain key, coins */
+  uint8_t kr[2*KYBER_SYMBYTES];
+  const uint8_t *sk = ctx->sk;
+  const uint8_t *pk = sk+KYBER_INDCPA_SECRETKEYBYTES;
+
+  if(ctx->len != KYBER_CIPHERTEXTBYTES)
+    return -1;
+
+  indcpa_dec_final(buf, ctx->acc, ctx->ct+KYBER_POLYVECCOMPRESSEDBYTES);
+
+  /* Multitarget countermeasure for coins + contributory KEM */
+  memcpy(buf+KYBER_SYMBYTES, sk+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, KYBER_SYMBYTES);
+  hash_g(kr, buf, 2*KYBER_SYMBYTES);
+
+  /* coins are in kr+KYBER_SYMBYTES */
+  fail = indcpa_enc_cmp(ctx->ct, buf, pk, kr+KYBER_SYMBYTES);
+
+  /* Rejection key, the cipher text has already been absorbed */
+  rkprf_finalize(ss, &ctx->rk);
+
+  /* Copy true key to return buffer if fail is false */
+  cmov(ss,kr,KYBER_SYMBYTES,!fail);
+
+  return 0;
+}
@@ -0,0 +1,319 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "params.h"
+#include "kem.h"
+#include "kem_batch.h"
+#include "randombytes.h"
+
+/*
+ * Fixed pool of worker threads for the batch calls (host only).
+ *
+ * crypto_kem_batch_start creates the workers once. A batch call publishes
+ * the job, wakes the workers and works on it itself as well; items are
+ * claimed one at a time from a shared counter, so threads that finish
+ * early take over the rest and nothing is allocated per call. Each thread
+ * has a cache-line aligned scratch area for the coins of keypair and enc,
+ * everything else is on its own stack. randombytes is not thread-safe
+ * (the host fallback has global state), so the coins are drawn through
+ * kem_batch_randombytes, which is shared by all parameter sets of a
+ * KYBER_MULTILEVEL build, and the work is done by the _derand functions.
+ */
+
+enum { BATCH_KEYPAIR, BATCH_ENC, BATCH_DEC };
+
+typedef struct {
+  pthread_t thread;
+  unsigned long seen;
+  uint8_t coins[2*KYBER_SYMBYTES];
+} __attribute__((aligned(64))) batch_worker;
+
+static struct {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  unsigned int nthreads;      // including the caller, 0 if not started
+  unsigned long generation;   // incremented for every job
+  unsigned int busy;          // workers still on the current job
+  int stop;
+  int op;
+  uint8_t *out0, *out1;
+  const uint8_t *in0, *in1;
+  size_t n;
+  atomic_size_t next;
+  atomic_int fail;
+  batch_worker worker[KYBER_BATCH_MAX_THREADS];   // worker[0] is the caller
+} pool = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .wake = PTHREAD_COND_INITIALIZER,
+  .done = PTHREAD_COND_INITIALIZER
+};
+
+/* Serializes batch calls, start and stop */
+static pthread_mutex_t batch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
+/* One lock for the pools of all parameter sets: randombytes has a single
+ * global state however many sets are linked in */
+static pthread_mutex_t rng_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*************************************************
+* Name:        kem_batch_randombytes
+*
+* Description: randombytes serialized across all threads of the batch pools
+*
+* Arguments:   - uint8_t *out: pointer to output
+*              - size_t len: number of bytes
+**************************************************/
+void kem_batch_randombytes(uint8_t *out, size_t len)
+{
+  pthread_mutex_lock(&rng_lock);
+  randombytes(out, len);
+  pthread_mutex_unlock(&rng_lock);
+}
+#endif
+
+/*************************************************
+* Name:        run_items
+*
+* Description: Processes items of the current job until none are left
+*
+* Arguments:   - batch_worker *w: scratch of the calling thread
+**************************************************/
+static void run_items(batch_worker *w)
+{
+  size_t i;
+  int r;
+
+  while((i = atomic_fetch_add(&pool.next, 1)) < pool.n) {
+    switch(pool.op) {
+      case BATCH_KEYPAIR:
+        kem_batch_randombytes(w->coins, 2*KYBER_SYMBYTES);
+        r = crypto_kem_keypair_derand(pool.out0 + i*KYBER_PUBLICKEYBYTES,
+                                      pool.out1 + i*KYBER_SECRETKEYBYTES, w->coins);
+        break;
+      case BATCH_ENC:
+        kem_batch_randombytes(w->coins, KYBER_SYMBYTES);
+        r = crypto_kem_enc_derand(pool.out0 + i*KYBER_CIPHERTEXTBYTES,
+                                  pool.out1 + i*KYBER_SSBYTES,
+                                  pool.in0 + i*KYBER_PUBLICKEYBYTES, w->coins);
+        break;
+      default:
+        r = crypto_kem_dec(pool.out0 + i*KYBER_SSBYTES,
+                           pool.in0 + i*KYBER_CIPHERTEXTBYTES,
+                           pool.in1 + i*KYBER_SECRETKEYBYTES);
+        break;
+    }
+    if(r != 0)
+      atomic_store(&pool.fail, 1);
+  }
+}
+
+static void *worker_main(void *arg)
+{
+  batch_worker *w = arg;
+
+  pthread_mutex_lock(&pool.lock);
+  for(;;) {
+    while(!pool.stop && pool.generation == w->seen)
+      pthread_cond_wait(&pool.wake, &pool.lock);
+    if(pool.stop)
+      break;
+    w->seen = pool.generation;
+    pthread_mutex_unlock(&pool.lock);
+
+    run_items(w);
+
+    pthread_mutex_lock(&pool.lock);
+    if(--pool.busy == 0)
+      pthread_cond_signal(&pool.done);
+  }
+  pthread_mutex_unlock(&pool.lock);
+  return NULL;
+}
+
+/*************************************************
+* Name:        run_job
+*
+* Description: Runs one batch on all threads of the pool and waits
+*              until every item is done
+*
+* Returns 0 if all operations succeeded, -1 otherwise
+**************************************************/
+static int run_job(int op, uint8_t *out0, uint8_t *out1,
+                   const uint8_t *in0, const uint8_t *in1, size_t n)
+{
+  int fail;
+
+  pthread_mutex_lock(&batch_lock);
+  pthread_mutex_lock(&pool.lock);
+  pool.op = op;
+  pool.out0 = out0;
+  pool.out1 = out1;
+  pool.in0 = in0;
+  pool.in1 = in1;
+  pool.n = n;
+  atomic_store(&pool.next, 0);
+  atomic_store(&pool.fail, 0);
+  if(pool.nthreads > 1) {
+    pool.busy = pool.nthreads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+  }
+  pthread_mutex_unlock(&pool.lock);
+
+  run_items(&pool.worker[0]);
+
+  pthread_mutex_lock(&pool.lock);
+  while(pool.busy != 0)
+    pthread_cond_wait(&pool.done, &pool.lock);
+  pthread_mutex_unlock(&pool.lock);
+
+  fail = atomic_load(&pool.fail);
+  pthread_mutex_unlock(&batch_lock);
+  return fail ? -1 : 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_batch_start
+*
+* Description: Starts the worker pool, replacing a running one. The
+*              calling thread of a batch call is one of the nthreads
+*              threads; nthreads = 0 selects one thread per online CPU.
+*              At most KYBER_BATCH_MAX_THREADS threads are used
+*
+* Arguments:   - unsigned int nthreads: number of threads
+*
+* Returns 0 on success, -1 if not all workers could be created
+* (the pool then runs with the ones that were)
+**************************************************/
+int crypto_kem_batch_start(unsigned int nthreads)
+{
+  unsigned int i;
+  long ncpu;
+
+  if(nthreads == 0) {
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = ncpu > 0 ? (unsigned int)ncpu : 1;
+  }
+  if(nthreads > KYBER_BATCH_MAX_THREADS)
+    nthreads = KYBER_BATCH_MAX_THREADS;
+
+  crypto_kem_batch_stop();
+
+  pthread_mutex_lock(&batch_lock);
+  pthread_mutex_lock(&pool.lock);
+  for(i=1;i<nthreads;i++) {
+    pool.worker[i].seen = pool.generation;
+    if(pthread_create(&pool.worker[i].thread, NULL, worker_main, &pool.worker[i]) != 0)
+      break;
+  }
+  pool.nthreads = i;
+  pthread_mutex_unlock(&pool.lock);
+  pthread_mutex_unlock(&batch_lock);
+
+  return i == nthreads ? 0 : -1;
+}
+
+/*************************************************
+* Name:        crypto_kem_batch_stop
+*
+* Description: Stops and joins the workers; later batch calls run on
+*              the calling thread until the pool is started again
+**************************************************/
+void crypto_kem_batch_stop(void)
+{
+  unsigned int i, n;
+
+  pthread_mutex_lock(&batch_lock);
+  pthread_mutex_lock(&pool.lock);
+  n = pool.nthreads;
+  pool.stop = 1;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  for(i=1;i<n;i++)
+    pthread_join(pool.worker[i].thread, NULL);
+
+  pthread_mutex_lock(&pool.lock);
+  pool.nthreads = 0;
+  pool.stop = 0;
+  pthread_mutex_unlock(&pool.lock);
+  pthread_mutex_unlock(&batch_lock);
+}
+
+/*************************************************
+* Name:        crypto_kem_batch_threads
+*
+* Description: Number of threads that work on a batch, including the caller
+**************************************************/
+unsigned int crypto_kem_batch_threads(void)
+{
+  unsigned int n;
+
+  pthread_mutex_lock(&pool.lock);
+  n = pool.nthreads > 1 ? pool.nthreads : 1;
+  pthread_mutex_unlock(&pool.lock);
+  return n;
+}
+
+/*************************************************
+* Name:        crypto_kem_keypair_batch
+*
+* Description: Generates n key pairs as crypto_kem_keypair
+*
+* Arguments:   - uint8_t *pk: pointer to output public keys
+*                (n*KYBER_PUBLICKEYBYTES bytes)
+*              - uint8_t *sk: pointer to output private keys
+*                (n*KYBER_SECRETKEYBYTES bytes)
+*              - size_t n: number of key pairs
+*
+* Returns 0 (success) or -1 if any keypair generation failed
+**************************************************/
+int crypto_kem_keypair_batch(uint8_t *pk, uint8_t *sk, size_t n)
+{
+  return run_job(BATCH_KEYPAIR, pk, sk, NULL, NULL, n);
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_batch
+*
+* Description: Encapsulates to n public keys as crypto_kem_enc
+*
+* Arguments:   - uint8_t *ct: pointer to output ciphertexts
+*                (n*KYBER_CIPHERTEXTBYTES bytes)
+*              - uint8_t *ss: pointer to output shared secrets
+*                (n*KYBER_SSBYTES bytes)
+*              - const uint8_t *pk: pointer to input public keys
+*                (n*KYBER_PUBLICKEYBYTES bytes)
+*              - size_t n: number of encapsulations
+*
+* Returns 0 (success) or -1 if any encapsulation failed
+**************************************************/
+int crypto_kem_enc_batch(uint8_t *ct, uint8_t *ss, const uint8_t *pk, size_t n)
+{
+  return run_job(BATCH_ENC, ct, ss, pk, NULL, n);
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_batch
+*
+* Description: Decapsulates n ciphertexts as crypto_kem_dec; ciphertext i
+*              is decapsulated with private key i
+*
+* Arguments:   - uint8_t *ss: pointer to output shared secrets
+*                (n*KYBER_SSBYTES bytes)
+*              - const uint8_t *ct: pointer to input ciphertexts
+*                (n*KYBER_CIPHERTEXTBYTES bytes)
+*              - const uint8_t *sk: pointer to input private keys
+*                (n*KYBER_SECRETKEYBYTES bytes)
+*              - size_t n: number of decapsulations
+*
+* Returns 0 (success) or -1 if any decapsulation failed
+**************************************************/
+int crypto_kem_dec_batch(uint8_t *ss, const uint8_t *ct, const uint8_t *sk, size_t n)
+{
+  return run_job(BATCH_DEC, ss, NULL, ct, sk, n);
+}
@@ -0,0 +1,40 @@
+#ifndef KEM_BATCH_H
+#define KEM_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+
+/*
+ * Batch KEM operations on a fixed pool of worker threads (host only).
+ * Item i of an array argument is at offset i times the size of one key,
+ * ciphertext or shared secret. Without crypto_kem_batch_start, the
+ * batch calls run on the calling thread.
+ */
+
+/* Largest number of threads of the pool, including the calling thread */
+#define KYBER_BATCH_MAX_THREADS 64
+
+#define crypto_kem_batch_start KYBER_NAMESPACE(batch_start)
+int crypto_kem_batch_start(unsigned int nthreads);
+
+#define crypto_kem_batch_stop KYBER_NAMESPACE(batch_stop)
+void crypto_kem_batch_stop(void);
+
+#define crypto_kem_batch_threads KYBER_NAMESPACE(batch_threads)
+unsigned int crypto_kem_batch_threads(void);
+
+#define crypto_kem_keypair_batch KYBER_NAMESPACE(keypair_batch)
+int crypto_kem_keypair_batch(uint8_t *pk, uint8_t *sk, size_t n);
+
+#define crypto_kem_enc_batch KYBER_NAMESPACE(enc_batch)
+int crypto_kem_enc_batch(uint8_t *ct, uint8_t *ss, const uint8_t *pk, size_t n);
+
+#define crypto_kem_dec_batch KYBER_NAMESPACE(dec_batch)
+int crypto_kem_dec_batch(uint8_t *ss, const uint8_t *ct, const uint8_t *sk, size_t n);
+
+/* randombytes under the lock that all batch pools share (internal) */
+#define kem_batch_randombytes KYBER_SHARED_NAMESPACE(batch_randombytes)
+void kem_batch_randombytes(uint8_t *out, size_t len);
+
+#endif
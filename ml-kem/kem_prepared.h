@@ -0,0 +1,41 @@
+#ifndef KEM_PREPARED_H
+#define KEM_PREPARED_H
+
+#include <stdint.h>
+#include "params.h"
+#include "indcpa.h"
+
+/*
+ * Public key expanded for repeated encapsulation, see crypto_kem_enc_prepare
+ */
+typedef struct{
+  indcpa_enc_ctx indcpa;
+  uint8_t hpk[KYBER_SYMBYTES];
+} crypto_kem_enc_ctx;
+
+#define crypto_kem_enc_prepare KYBER_NAMESPACE(enc_prepare)
+int crypto_kem_enc_prepare(crypto_kem_enc_ctx *ctx, const uint8_t *pk);
+
+#define crypto_kem_enc_prepared_derand KYBER_NAMESPACE(enc_prepared_derand)
+int crypto_kem_enc_prepared_derand(uint8_t *ct, uint8_t *ss, const crypto_kem_enc_ctx *ctx, const uint8_t *coins);
+
+#define crypto_kem_enc_prepared KYBER_NAMESPACE(enc_prepared)
+int crypto_kem_enc_prepared(uint8_t *ct, uint8_t *ss, const crypto_kem_enc_ctx *ctx);
+
+/*
+ * Secret key expanded for repeated decapsulation, see crypto_kem_dec_prepare
+ */
+typedef struct{
+  indcpa_dec_ctx indcpa_dec;
+  indcpa_enc_ctx indcpa_enc;
+  uint8_t hpk[KYBER_SYMBYTES];
+  uint8_t z[KYBER_SYMBYTES];
+} crypto_kem_dec_ctx;
+
+#define crypto_kem_dec_prepare KYBER_NAMESPACE(dec_prepare)
+int crypto_kem_dec_prepare(crypto_kem_dec_ctx *ctx, const uint8_t *sk);
+
+#define crypto_kem_dec_prepared KYBER_NAMESPACE(dec_prepared)
+int crypto_kem_dec_prepared(uint8_t *ss, const uint8_t *ct, const crypto_kem_dec_ctx *ctx);
+
+#endif
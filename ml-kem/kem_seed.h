@@ -0,0 +1,29 @@
+#ifndef KEM_SEED_H
+#define KEM_SEED_H
+
+#include <stdint.h>
+#include "params.h"
+#include "kem_prepared.h"
+
+/*
+ * Seed-format private keys: only the KYBER_SEEDKEYBYTES seed (d, z) of
+ * the key generation is stored, the expanded private key is regenerated
+ * from it when needed. crypto_kem_dec_prepare_seed caches the expansion
+ * in a crypto_kem_dec_ctx for keys that are used repeatedly.
+ */
+#define crypto_kem_keypair_seed_derand KYBER_NAMESPACE(keypair_seed_derand)
+int crypto_kem_keypair_seed_derand(uint8_t *pk, uint8_t *seed, const uint8_t *coins);
+
+#define crypto_kem_keypair_seed KYBER_NAMESPACE(keypair_seed)
+int crypto_kem_keypair_seed(uint8_t *pk, uint8_t *seed);
+
+#define crypto_kem_seed_expand KYBER_NAMESPACE(seed_expand)
+int crypto_kem_seed_expand(uint8_t *sk, const uint8_t *seed);
+
+#define crypto_kem_dec_seed KYBER_NAMESPACE(dec_seed)
+int crypto_kem_dec_seed(uint8_t *ss, const uint8_t *ct, const uint8_t *seed);
+
+#define crypto_kem_dec_prepare_seed KYBER_NAMESPACE(dec_prepare_seed)
+int crypto_kem_dec_prepare_seed(crypto_kem_dec_ctx *ctx, const uint8_t *seed);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef KEM_STREAM_H
+#define KEM_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "fips202.h"
+
+/*
+ * Incremental encapsulation for a public key that arrives in chunks, see
+ * crypto_kem_enc_init
+ */
+typedef struct{
+  keccak_state hpk;
+  uint8_t pk[KYBER_PUBLICKEYBYTES];
+  size_t len;
+} crypto_kem_enc_stream_ctx;
+
+#define crypto_kem_enc_init KYBER_NAMESPACE(enc_init)
+int crypto_kem_enc_init(crypto_kem_enc_stream_ctx *ctx);
+
+#define crypto_kem_enc_update KYBER_NAMESPACE(enc_update)
+int crypto_kem_enc_update(crypto_kem_enc_stream_ctx *ctx, const uint8_t *in, size_t inlen);
+
+#define crypto_kem_enc_final_derand KYBER_NAMESPACE(enc_final_derand)
+int crypto_kem_enc_final_derand(uint8_t *ct, uint8_t *ss, crypto_kem_enc_stream_ctx *ctx, const uint8_t *coins);
+
+#define crypto_kem_enc_final KYBER_NAMESPACE(enc_final)
+int crypto_kem_enc_final(uint8_t *ct, uint8_t *ss, crypto_kem_enc_stream_ctx *ctx);
+
+/*
+ * Incremental decapsulation for a ciphertext that arrives in chunks, see
+ * crypto_kem_dec_init
+ */
+typedef struct{
+  const uint8_t *sk;
+  keccak_state rk;
+  int32_t acc[KYBER_N];
+  uint8_t ct[KYBER_CIPHERTEXTBYTES];
+  size_t len;
+} crypto_kem_dec_stream_ctx;
+
+#define crypto_kem_dec_init KYBER_NAMESPACE(dec_init)
+int crypto_kem_dec_init(crypto_kem_dec_stream_ctx *ctx, const uint8_t *sk);
+
+#define crypto_kem_dec_update KYBER_NAMESPACE(dec_update)
+int crypto_kem_dec_update(crypto_kem_dec_stream_ctx *ctx, const uint8_t *in, size_t inlen);
+
+#define crypto_kem_dec_final KYBER_NAMESPACE(dec_final)
+int crypto_kem_dec_final(uint8_t *ss, crypto_kem_dec_stream_ctx *ctx);
+
+#endif
@@ -69,11 +69,119 @@ static int16_t fqmul(int16_t a, int16_t b) {
   return montgomery_reduce((int32_t)a*b);
 }
 
+#if defined(__ARM_FEATURE_DSP)
+/* Zetas in the order in which ntt_m4 consumes them: zetas[1..7] for layers
+ * 1-3, then for each block b of 32 coefficients zetas[8+b], zetas[16+2b..17+2b]
+ * and zetas[32+4b..35+4b] for layers 4-6, then zetas[64..127] for layer 7.
+ * Each group of seven is padded to eight for word-aligned loads. */
+const int16_t zetas_ntt_m4[136] __attribute__((aligned(4))) = {
+   -758,  -359, -1517,  1493,  1422,   287,   202,     0,
+   -171,   573, -1325,  1223,   652,  -552,  1015,     0,
+    622,   264,   383, -1293,  1491,  -282, -1544,     0,
+   1577,  -829,  1458,   516,    -8,  -320,  -666,     0,
+    182, -1602,  -130, -1618, -1162,   126,  1469,     0,
+    962,  -681,  1017,  -853,   -90,  -271,   830,     0,
+  -1202,   732,   608,   107, -1421,  -247,  -951,     0,
+  -1474, -1542,   411,  -398,   961, -1508,  -725,     0,
+   1468,  -205, -1571,   448, -1065,   677, -1275,     0,
+  -1103,   430,   555,   843, -1251,   871,  1550,   105,
+    422,   587,   177,  -235,  -291,  -460,  1574,  1653,
+   -246,   778,  1159,  -147,  -777,  1483,  -602,  1119,
+  -1590,   644,  -872,   349,   418,   329,  -156,   -75,
+    817,  1097,   603,   610,  1322, -1285, -1465,   384,
+  -1215,  -136,  1218, -1335,  -874,   220, -1187, -1659,
+  -1185, -1530, -1278,   794, -1510,  -854,  -870,   478,
+   -108,  -308,   996,   991,   958, -1460,  1522,  1628
+};
+
+/* Zetas in the order in which invntt_m4 consumes them: zetas[127..64] for
+ * layer 1, for each block b zetas[63-4b..60-4b], zetas[31-2b..30-2b] and
+ * zetas[15-b] for layers 2-4, then zetas[7..2] for layers 5-6 followed by
+ * f = mont^2/128 and zetas[1]*f/mont for layer 7 */
+const int16_t zetas_invntt_m4[136] __attribute__((aligned(4))) = {
+   1628,  1522, -1460,   958,   991,   996,  -308,  -108,
+    478,  -870,  -854, -1510,   794, -1278, -1530, -1185,
+  -1659, -1187,   220,  -874, -1335,  1218,  -136, -1215,
+    384, -1465, -1285,  1322,   610,   603,  1097,   817,
+    -75,  -156,   329,   418,   349,  -872,   644, -1590,
+   1119,  -602,  1483,  -777,  -147,  1159,   778,  -246,
+   1653,  1574,  -460,  -291,  -235,   177,   587,   422,
+    105,  1550,   871, -1251,   843,   555,   430, -1103,
+  -1275,   677, -1065,   448, -1571,  -205,  1468,     0,
+   -725, -1508,   961,  -398,   411, -1542, -1474,     0,
+   -951,  -247, -1421,   107,   608,   732, -1202,     0,
+    830,  -271,   -90,  -853,  1017,  -681,   962,     0,
+   1469,   126, -1162, -1618,  -130, -1602,   182,     0,
+   -666,  -320,    -8,   516,  1458,  -829,  1577,     0,
+  -1544,  -282,  1491, -1293,   383,   264,   622,     0,
+   1015,  -552,   652,  1223, -1325,   573,  -171,     0,
+    202,   287,  1422,  1493, -1517,  -359,  1441,  1397
+};
+
+/*************************************************
+* Name:        ntt
+*
+* Description: Inplace number-theoretic transform (NTT) in Rq.
+*              input is in standard order, output is in bitreversed order
+*              and Barrett reduced. Cortex-M4 implementation in ntt_m4.S
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void ntt(int16_t r[256]) {
+  ntt_m4(r, zetas_ntt_m4);
+}
+
+/*************************************************
+* Name:        invntt_tomont
+*
+* Description: Inplace inverse number-theoretic transform in Rq and
+*              multiplication by Montgomery factor 2^16.
+*              Input is in bitreversed order, output is in standard order
+*              and below 3q/4 in absolute value. Cortex-M4 implementation
+*              in ntt_m4.S
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void invntt(int16_t r[256]) {
+  invntt_m4(r, zetas_invntt_m4);
+}
+#elif defined(__AVX2__)
 /*************************************************
 * Name:        ntt
 *
 * Description: Inplace number-theoretic transform (NTT) in Rq.
 *              input is in standard order, output is in bitreversed order
+*              and Barrett reduced. AVX2 implementation in ntt_avx2.c
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void ntt(int16_t r[256]) {
+  ntt_avx2(r);
+}
+
+/*************************************************
+* Name:        invntt_tomont
+*
+* Description: Inplace inverse number-theoretic transform in Rq and
+*              multiplication by Montgomery factor 2^16.
+*              Input is in bitreversed order, output is in standard order
+*              and below 3q/4 in absolute value. AVX2 implementation
+*              in ntt_avx2.c
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void invntt(int16_t r[256]) {
+  invntt_avx2(r);
+}
+#else
+/*************************************************
+* Name:        ntt
+*
+* Description: Inplace number-theoretic transform (NTT) in Rq.
+*              input is in standard order, output is in bitreversed order.
+*              Coefficients grow by less than q per layer, so inputs
+*              in {-q+1,...,q-1} need no reduction before the last layer,
+*              whose outputs are Barrett reduced to {-(q-1)/2,...,(q-1)/2}
 *
 * Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
 **************************************************/
@@ -82,7 +190,7 @@ void ntt(int16_t r[256]) {
   int16_t t, zeta;
 
   k = 1;
-  for(len = 128; len >= 2; len >>= 1) {
+  for(len = 128; len >= 4; len >>= 1) {
     for(start = 0; start < 256; start = j + len) {
       zeta = zetas[k++];
       for(j = start; j < start + len; j++) {
@@ -92,6 +200,15 @@ void ntt(int16_t r[256]) {
       }
     }
   }
+
+  for(start = 0; start < 256; start += 4) {
+    zeta = zetas[k++];
+    for(j = start; j < start + 2; j++) {
+      t = fqmul(zeta, r[j + 2]);
+      r[j + 2] = barrett_reduce(r[j] - t);
+      r[j] = barrett_reduce(r[j] + t);
+    }
+  }
 }
 
 /*************************************************
@@ -99,31 +216,45 @@ void ntt(int16_t r[256]) {
 *
 * Description: Inplace inverse number-theoretic transform in Rq and
 *              multiplication by Montgomery factor 2^16.
-*              Input is in bitreversed order, output is in standard order
+*              Input is in bitreversed order, output is in standard order.
+*              Sums at most double per layer, so for inputs in
+*              {-q+1,...,q-1} Barrett reductions are only needed in the
+*              layers with len = 8 and len = 64, which keeps all
+*              intermediates below 8q. The multiplication by f is merged
+*              into the last layer; outputs are below 3q/4 in absolute value.
 *
 * Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
 **************************************************/
 void invntt(int16_t r[256]) {
   unsigned int start, len, j, k;
   int16_t t, zeta;
+  int reduce;
   const int16_t f = 1441; // mont^2/128
 
   k = 127;
-  for(len = 2; len <= 128; len <<= 1) {
+  for(len = 2; len <= 64; len <<= 1) {
+    reduce = (len == 8 || len == 64);
     for(start = 0; start < 256; start = j + len) {
       zeta = zetas[k--];
       for(j = start; j < start + len; j++) {
         t = r[j];
-        r[j] = barrett_reduce(t + r[j + len]);
+        r[j] = t + r[j + len];
+        if(reduce)
+          r[j] = barrett_reduce(r[j]);
         r[j + len] = r[j + len] - t;
         r[j + len] = fqmul(zeta, r[j + len]);
       }
     }
   }
 
-  for(j = 0; j < 256; j++)
-    r[j] = fqmul(r[j], f);
+  zeta = fqmul(zetas[1], f);
+  for(j = 0; j < 128; j++) {
+    t = r[j];
+    r[j] = fqmul(t + r[j + 128], f);
+    r[j + 128] = fqmul(r[j + 128] - t, zeta);
+  }
 }
+#endif
 
 /*************************************************
 * Name:        basemul
@@ -4,16 +4,39 @@
 #include <stdint.h>
 #include "params.h"
 
-#define zetas KYBER_NAMESPACE(zetas)
+/* Exclusive bound on the absolute value of the outputs of invntt */
+#define INVNTT_BOUND ((3*KYBER_Q)/4)
+
+#define zetas KYBER_SHARED_NAMESPACE(zetas)
 extern const int16_t zetas[128];
 
-#define ntt KYBER_NAMESPACE(ntt)
+#define ntt KYBER_SHARED_NAMESPACE(ntt)
 void ntt(int16_t poly[256]);
 
-#define invntt KYBER_NAMESPACE(invntt)
+#define invntt KYBER_SHARED_NAMESPACE(invntt)
 void invntt(int16_t poly[256]);
 
-#define basemul KYBER_NAMESPACE(basemul)
+#if defined(__ARM_FEATURE_DSP)
+#define zetas_ntt_m4 KYBER_SHARED_NAMESPACE(zetas_ntt_m4)
+extern const int16_t zetas_ntt_m4[136];
+
+#define zetas_invntt_m4 KYBER_SHARED_NAMESPACE(zetas_invntt_m4)
+extern const int16_t zetas_invntt_m4[136];
+
+#define ntt_m4 KYBER_SHARED_NAMESPACE(ntt_m4)
+void ntt_m4(int16_t poly[256], const int16_t zetas[136]);
+
+#define invntt_m4 KYBER_SHARED_NAMESPACE(invntt_m4)
+void invntt_m4(int16_t poly[256], const int16_t zetas[136]);
+#elif defined(__AVX2__)
+#define ntt_avx2 KYBER_SHARED_NAMESPACE(ntt_avx2)
+void ntt_avx2(int16_t poly[256]);
+
+#define invntt_avx2 KYBER_SHARED_NAMESPACE(invntt_avx2)
+void invntt_avx2(int16_t poly[256]);
+#endif
+
+#define basemul KYBER_SHARED_NAMESPACE(basemul)
 void basemul(int16_t r[2], const int16_t a[2], const int16_t b[2], int16_t zeta);
 
 #endif
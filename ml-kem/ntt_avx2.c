@@ -0,0 +1,147 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include <stdint.h>
+#include "params.h"
+#include "ntt.h"
+#include "ntt_avx2.h"
+#include "poly.h"
+#include "reduce.h"
+
+/*
+ * AVX2 number-theoretic transforms and base multiplication for ML-KEM
+ * (host only). Polynomials keep the coefficient order of ntt.c, so the
+ * byte formats and all other code are unchanged; the transforms themselves
+ * are in ntt_avx2.h.
+ */
+
+/*************************************************
+* Name:        ntt_avx2
+*
+* Description: AVX2 implementation of ntt; same output as the C code
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void ntt_avx2(int16_t r[256])
+{
+  unsigned int i;
+  __m256i v[16];
+
+  for(i=0;i<16;i++)
+    v[i] = _mm256_loadu_si256((const __m256i *)&r[16*i]);
+  ntt_avx2_regs(v);
+  for(i=0;i<16;i++)
+    _mm256_storeu_si256((__m256i *)&r[16*i], v[i]);
+}
+
+/*************************************************
+* Name:        invntt_avx2
+*
+* Description: AVX2 implementation of invntt; same output as the C code
+*
+* Arguments:   - int16_t r[256]: pointer to input/output vector of elements of Zq
+**************************************************/
+void invntt_avx2(int16_t r[256])
+{
+  unsigned int i;
+  __m256i v[16];
+
+  for(i=0;i<16;i++)
+    v[i] = _mm256_loadu_si256((const __m256i *)&r[16*i]);
+  invntt_avx2_regs(v);
+  for(i=0;i<16;i++)
+    _mm256_storeu_si256((__m256i *)&r[16*i], v[i]);
+}
+
+/*************************************************
+* Name:        poly_mulcache_compute_avx2
+*
+* Description: AVX2 implementation of poly_mulcache_compute: the odd
+*              coefficients are gathered 16 at a time and multiplied with
+*              zetas[64+i] and -zetas[64+i] in alternation
+*
+* Arguments:   - poly_mulcache *x: pointer to output cache
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_mulcache_compute_avx2(poly_mulcache *x, const poly *a)
+{
+  unsigned int i;
+  __m256i f0, f1, z;
+  __m128i zz;
+
+  for(i=0;i<KYBER_N/32;i++) {
+    f0 = _mm256_loadu_si256((const __m256i *)&a->coeffs[32*i]);
+    f1 = _mm256_loadu_si256((const __m256i *)&a->coeffs[32*i+16]);
+    f0 = _mm256_packs_epi32(_mm256_srai_epi32(f0, 16), _mm256_srai_epi32(f1, 16));
+    f0 = _mm256_permute4x64_epi64(f0, 0xD8);
+
+    zz = _mm_loadu_si128((const __m128i *)&zetas[64+8*i]);
+    z = _mm256_set_m128i(_mm_unpackhi_epi16(zz, _mm_sub_epi16(_mm_setzero_si128(), zz)),
+                         _mm_unpacklo_epi16(zz, _mm_sub_epi16(_mm_setzero_si128(), zz)));
+    _mm256_storeu_si256((__m256i *)&x->coeffs[16*i], fqmul(f0, z));
+  }
+}
+
+/* Montgomery reduction of 32-bit lanes, same as montgomery_reduce; the
+ * result is in the low half of each lane */
+static __m256i montgomery_reduce32(__m256i a)
+{
+  __m256i t;
+
+  t = _mm256_mullo_epi32(a, _mm256_set1_epi32(QINV));
+  t = _mm256_srai_epi32(_mm256_slli_epi32(t, 16), 16);
+  t = _mm256_mullo_epi32(t, _mm256_set1_epi32(KYBER_Q));
+  return _mm256_srai_epi32(_mm256_sub_epi32(a, t), 16);
+}
+
+/*************************************************
+* Name:        poly_basemul_acc_avx2
+*
+* Description: AVX2 implementation of the cached base multiplication of
+*              polyvec.c for k polynomials: eight coefficient pairs at a
+*              time, the products of each pair are summed in 32 bits with
+*              VPMADDWD against (b0, b_cache) and (b1, b0) and reduced
+*              once, as in basemul_acc_cached. If e is not NULL, the result
+*              is converted to normal domain and e is added as in
+*              polyvec_basemul_acc_add_cached.
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const poly *a: pointer to the k polynomials of the first factor
+*              - const poly *b: pointer to the k polynomials of the second factor
+*              - const poly_mulcache *b_cache: pointer to the k caches of b
+*              - unsigned int k: number of polynomials
+*              - const poly *e: pointer to polynomial to add or NULL
+**************************************************/
+void poly_basemul_acc_avx2(poly *r,
+                           const poly *a,
+                           const poly *b,
+                           const poly_mulcache *b_cache,
+                           unsigned int k,
+                           const poly *e)
+{
+  unsigned int i, j;
+  const __m256i fm = _mm256_set1_epi32(((uint32_t)(uint16_t)MONT << 16) | (uint16_t)((1ULL << 32) % KYBER_Q));
+  __m256i x, y, c, t0, t1, u;
+
+  for(i=0;i<KYBER_N/16;i++) {
+    t0 = t1 = _mm256_setzero_si256();
+    for(j=0;j<k;j++) {
+      x = _mm256_loadu_si256((const __m256i *)&a[j].coeffs[16*i]);
+      y = _mm256_loadu_si256((const __m256i *)&b[j].coeffs[16*i]);
+      c = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&b_cache[j].coeffs[8*i]));
+      t0 = _mm256_add_epi32(t0, _mm256_madd_epi16(x, _mm256_blend_epi16(y, _mm256_slli_epi32(c, 16), 0xAA)));
+      t1 = _mm256_add_epi32(t1, _mm256_madd_epi16(x, _mm256_or_si256(_mm256_srli_epi32(y, 16), _mm256_slli_epi32(y, 16))));
+    }
+    t0 = montgomery_reduce32(t0);
+    t1 = montgomery_reduce32(t1);
+
+    if(e) {
+      // u*2^32 + e*2^16 mod q, with (u, e) against (2^32 mod q, 2^16 mod q)
+      u = _mm256_loadu_si256((const __m256i *)&e->coeffs[16*i]);
+      t0 = montgomery_reduce32(_mm256_madd_epi16(_mm256_blend_epi16(t0, _mm256_slli_epi32(u, 16), 0xAA), fm));
+      t1 = montgomery_reduce32(_mm256_madd_epi16(_mm256_blend_epi16(t1, u, 0xAA), fm));
+    }
+
+    _mm256_storeu_si256((__m256i *)&r->coeffs[16*i], _mm256_blend_epi16(t0, _mm256_slli_epi32(t1, 16), 0xAA));
+  }
+}
+#endif
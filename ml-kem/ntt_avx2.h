@@ -0,0 +1,225 @@
+#ifndef NTT_AVX2_H
+#define NTT_AVX2_H
+
+#include <immintrin.h>
+#include <stdint.h>
+#include "params.h"
+#include "ntt.h"
+#include "reduce.h"
+
+/*
+ * Register-level AVX2 transforms shared by ntt_avx2.c and the fused
+ * kernels in compress_avx2.c (host only). A polynomial is held in 16
+ * registers of 16 coefficients each, in the coefficient order of ntt.c.
+ *
+ * For len >= 16 the layers combine whole registers. For len = 8, 4 and 2
+ * each pair of registers is transposed in place (128-bit, 64-bit and
+ * 32-bit interleaving, see shuffle128/64/32) so that these butterflies are
+ * again lane-wise, and transposed back afterwards. Each lane computes
+ * exactly what ntt.c computes: fqmul is the Montgomery reduction of the
+ * 32-bit product from its high and low halves, and the Barrett reductions
+ * are done in the same layers, so outputs are identical to the C code.
+ */
+
+/* Montgomery multiplication of all lanes, same as fqmul in ntt.c */
+static inline __m256i fqmul(__m256i a, __m256i b)
+{
+  const __m256i q = _mm256_set1_epi16(KYBER_Q);
+  const __m256i qinv = _mm256_set1_epi16(QINV);
+  __m256i lo, hi;
+
+  lo = _mm256_mullo_epi16(_mm256_mullo_epi16(a, b), qinv);
+  hi = _mm256_mulhi_epi16(a, b);
+  return _mm256_sub_epi16(hi, _mm256_mulhi_epi16(lo, q));
+}
+
+/* Barrett reduction of all lanes, same as barrett_reduce */
+static inline __m256i barrett(__m256i a)
+{
+  const __m256i q = _mm256_set1_epi16(KYBER_Q);
+  const __m256i v = _mm256_set1_epi16(((1<<26) + KYBER_Q/2)/KYBER_Q);
+  __m256i t;
+
+  // ((v*a >> 16) + 2^9) >> 10 equals (v*a + 2^25) >> 26
+  t = _mm256_mulhi_epi16(a, v);
+  t = _mm256_add_epi16(t, _mm256_set1_epi16(1 << 9));
+  t = _mm256_srai_epi16(t, 10);
+  return _mm256_sub_epi16(a, _mm256_mullo_epi16(t, q));
+}
+
+/* Cooley-Tukey butterfly of ntt; with reduce, both outputs are Barrett reduced */
+static inline void ct_butterfly(__m256i *a, __m256i *b, __m256i zeta, int reduce)
+{
+  __m256i t;
+
+  t = fqmul(zeta, *b);
+  *b = _mm256_sub_epi16(*a, t);
+  *a = _mm256_add_epi16(*a, t);
+  if(reduce) {
+    *a = barrett(*a);
+    *b = barrett(*b);
+  }
+}
+
+/* Gentleman-Sande butterfly of invntt; with reduce, the sum is Barrett reduced */
+static inline void gs_butterfly(__m256i *a, __m256i *b, __m256i zeta, int reduce)
+{
+  __m256i t;
+
+  t = *a;
+  *a = _mm256_add_epi16(t, *b);
+  if(reduce)
+    *a = barrett(*a);
+  *b = fqmul(zeta, _mm256_sub_epi16(*b, t));
+}
+
+/*
+ * In-place transposes of a register pair, each its own inverse. With
+ * a = a0 a1 and b = b0 b1 in units of 128, 64 or 32 bits (per 128-bit
+ * lane for the smaller units), they give a = a0 b0 and b = a1 b1.
+ */
+static inline void shuffle128(__m256i *a, __m256i *b)
+{
+  __m256i t;
+
+  t  = _mm256_permute2x128_si256(*a, *b, 0x20);
+  *b = _mm256_permute2x128_si256(*a, *b, 0x31);
+  *a = t;
+}
+
+static inline void shuffle64(__m256i *a, __m256i *b)
+{
+  __m256i t;
+
+  t  = _mm256_unpacklo_epi64(*a, *b);
+  *b = _mm256_unpackhi_epi64(*a, *b);
+  *a = t;
+}
+
+static inline void shuffle32(__m256i *a, __m256i *b)
+{
+  __m256i t;
+
+  t  = _mm256_blend_epi32(*a, _mm256_slli_epi64(*b, 32), 0xAA);
+  *b = _mm256_blend_epi32(_mm256_srli_epi64(*a, 32), *b, 0xAA);
+  *a = t;
+}
+
+/*
+ * Zetas of one register pair (coefficients 32p to 32p+31) in the layers
+ * with len = 8, 4 and 2: after shuffle128, shuffle64 and shuffle32 the
+ * butterfly blocks of these layers appear in order, with each zeta
+ * repeated over 8, 4 and 2 lanes. The inverse transform consumes the same
+ * zetas in reverse.
+ */
+static inline __m256i zetas_len8(unsigned int k, int rev)
+{
+  return _mm256_set_m128i(_mm_set1_epi16(zetas[rev ? k-1 : k+1]), _mm_set1_epi16(zetas[k]));
+}
+
+static inline __m256i zetas_len4(unsigned int k, int rev)
+{
+  const __m256i fwd = _mm256_setr_epi8(0,1,0,1,0,1,0,1,2,3,2,3,2,3,2,3,
+                                       4,5,4,5,4,5,4,5,6,7,6,7,6,7,6,7);
+  const __m256i bwd = _mm256_setr_epi8(6,7,6,7,6,7,6,7,4,5,4,5,4,5,4,5,
+                                       2,3,2,3,2,3,2,3,0,1,0,1,0,1,0,1);
+  __m256i z;
+
+  z = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *)&zetas[rev ? k-3 : k]));
+  return _mm256_shuffle_epi8(z, rev ? bwd : fwd);
+}
+
+static inline __m256i zetas_len2(unsigned int k, int rev)
+{
+  const __m256i fwd = _mm256_setr_epi8(0,1,0,1,2,3,2,3,4,5,4,5,6,7,6,7,
+                                       8,9,8,9,10,11,10,11,12,13,12,13,14,15,14,15);
+  const __m256i bwd = _mm256_setr_epi8(14,15,14,15,12,13,12,13,10,11,10,11,8,9,8,9,
+                                       6,7,6,7,4,5,4,5,2,3,2,3,0,1,0,1);
+  __m256i z;
+
+  z = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&zetas[rev ? k-7 : k]));
+  return _mm256_shuffle_epi8(z, rev ? bwd : fwd);
+}
+
+/*************************************************
+* Name:        ntt_avx2_regs
+*
+* Description: ntt of a polynomial held in registers
+*
+* Arguments:   - __m256i v[16]: input/output coefficients
+**************************************************/
+static inline void ntt_avx2_regs(__m256i v[16])
+{
+  unsigned int i, j;
+
+  // len = 128, 64, 32 on whole registers
+  for(i=0;i<8;i++)
+    ct_butterfly(&v[i], &v[i+8], _mm256_set1_epi16(zetas[1]), 0);
+  for(j=0;j<2;j++)
+    for(i=0;i<4;i++)
+      ct_butterfly(&v[8*j+i], &v[8*j+i+4], _mm256_set1_epi16(zetas[2+j]), 0);
+  for(j=0;j<4;j++)
+    for(i=0;i<2;i++)
+      ct_butterfly(&v[4*j+i], &v[4*j+i+2], _mm256_set1_epi16(zetas[4+j]), 0);
+
+  // len = 16 to 2 within each register pair
+  for(j=0;j<8;j++) {
+    ct_butterfly(&v[2*j], &v[2*j+1], _mm256_set1_epi16(zetas[8+j]), 0);
+    shuffle128(&v[2*j], &v[2*j+1]);
+    ct_butterfly(&v[2*j], &v[2*j+1], zetas_len8(16+2*j, 0), 0);
+    shuffle64(&v[2*j], &v[2*j+1]);
+    ct_butterfly(&v[2*j], &v[2*j+1], zetas_len4(32+4*j, 0), 0);
+    shuffle32(&v[2*j], &v[2*j+1]);
+    ct_butterfly(&v[2*j], &v[2*j+1], zetas_len2(64+8*j, 0), 1);
+    shuffle32(&v[2*j], &v[2*j+1]);
+    shuffle64(&v[2*j], &v[2*j+1]);
+    shuffle128(&v[2*j], &v[2*j+1]);
+  }
+}
+
+/*************************************************
+* Name:        invntt_avx2_regs
+*
+* Description: invntt of a polynomial held in registers, including the
+*              multiplication by mont^2/128
+*
+* Arguments:   - __m256i v[16]: input/output coefficients
+**************************************************/
+static inline void invntt_avx2_regs(__m256i v[16])
+{
+  unsigned int i, j;
+  __m256i t, f, zeta;
+
+  // len = 2 to 16 within each register pair
+  for(j=0;j<8;j++) {
+    shuffle128(&v[2*j], &v[2*j+1]);
+    shuffle64(&v[2*j], &v[2*j+1]);
+    shuffle32(&v[2*j], &v[2*j+1]);
+    gs_butterfly(&v[2*j], &v[2*j+1], zetas_len2(127-8*j, 1), 0);
+    shuffle32(&v[2*j], &v[2*j+1]);
+    gs_butterfly(&v[2*j], &v[2*j+1], zetas_len4(63-4*j, 1), 0);
+    shuffle64(&v[2*j], &v[2*j+1]);
+    gs_butterfly(&v[2*j], &v[2*j+1], zetas_len8(31-2*j, 1), 1);
+    shuffle128(&v[2*j], &v[2*j+1]);
+    gs_butterfly(&v[2*j], &v[2*j+1], _mm256_set1_epi16(zetas[15-j]), 0);
+  }
+
+  // len = 32, 64 on whole registers
+  for(j=0;j<4;j++)
+    for(i=0;i<2;i++)
+      gs_butterfly(&v[4*j+i], &v[4*j+i+2], _mm256_set1_epi16(zetas[7-j]), 0);
+  for(j=0;j<2;j++)
+    for(i=0;i<4;i++)
+      gs_butterfly(&v[8*j+i], &v[8*j+i+4], _mm256_set1_epi16(zetas[3-j]), 1);
+
+  // last layer merged with the multiplication by f = mont^2/128
+  f = _mm256_set1_epi16(1441);
+  zeta = _mm256_set1_epi16(montgomery_reduce((int32_t)zetas[1]*1441));
+  for(i=0;i<8;i++) {
+    t = v[i];
+    v[i] = fqmul(_mm256_add_epi16(t, v[i+8]), f);
+    v[i+8] = fqmul(_mm256_sub_epi16(v[i+8], t), zeta);
+  }
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef NTT_M4_H
+#define NTT_M4_H
+
+/*
+ * Assembler macros for the Cortex-M4 transforms, shared by ntt_m4.S and
+ * the fused kernels in compress_m4.S (include after .syntax/.thumb).
+ *
+ * Every 32-bit register holds two adjacent int16 coefficients; both halves
+ * of a register always take part in the same butterfly with the same zeta,
+ * so one butterfly macro processes two butterflies. Multiplications by zetas
+ * use Montgomery reduction with SMULxx/SMLABB: the constant register qqinv
+ * holds -q in its bottom and q^-1 mod 2^16 in its top half.
+ *
+ * Zetas are consumed from a table in ntt.c (zetas_ntt_m4, zetas_invntt_m4)
+ * that lists them in the order the code uses them, two per word.
+ */
+
+/* qqinv = -q in the bottom and q^-1 mod 2^16 in the top half */
+.macro load_qqinv qqinv
+  movw \qqinv, #(-KYBER_Q & 0xffff)
+  movt \qqinv, #(-3327 & 0xffff)
+.endm
+
+/* a = top half of (a + (a*qinv mod 2^16)*(-q)), i.e. a*2^-16 mod q; uses tmp */
+.macro montgomery a, qqinv, tmp
+  smulbt \tmp, \a, \qqinv
+  smlabb \a, \tmp, \qqinv, \a
+.endm
+
+/* Cooley-Tukey: (a, b) <- (a + zeta*b, a - zeta*b); zeta in half zh of zeta */
+.macro ct_butterfly a, b, zeta, zh, qqinv, t0, t1
+  smulb\zh \t0, \b, \zeta
+  smult\zh \t1, \b, \zeta
+  montgomery \t0, \qqinv, \b
+  montgomery \t1, \qqinv, \b
+  pkhtb \t0, \t1, \t0, asr #16
+  ssub16 \b, \a, \t0
+  sadd16 \a, \a, \t0
+.endm
+
+/* Gentleman-Sande: (a, b) <- (a + b, zeta*(b - a)) */
+.macro gs_butterfly a, b, zeta, zh, qqinv, t0, t1
+  ssub16 \t0, \b, \a
+  sadd16 \a, \a, \b
+  smulb\zh \t1, \t0, \zeta
+  smult\zh \t0, \t0, \zeta
+  montgomery \t1, \qqinv, \b
+  montgomery \t0, \qqinv, \b
+  pkhtb \b, \t0, \t1, asr #16
+.endm
+
+/* Last Gentleman-Sande layer with the scaling by f = mont^2/128 folded in:
+ * (a, b) <- (f*(a + b), zf*(b - a)) with f in the bottom and zf = zeta*f
+ * in the top half of zeta */
+.macro gs_butterfly_last a, b, zeta, qqinv, t0, t1
+  ssub16 \t0, \b, \a
+  sadd16 \a, \a, \b
+  smulbb \t1, \a, \zeta
+  smultb \a, \a, \zeta
+  montgomery \t1, \qqinv, \b
+  montgomery \a, \qqinv, \b
+  pkhtb \a, \a, \t1, asr #16
+  smulbt \t1, \t0, \zeta
+  smultt \t0, \t0, \zeta
+  montgomery \t1, \qqinv, \b
+  montgomery \t0, \qqinv, \b
+  pkhtb \b, \t0, \t1, asr #16
+.endm
+
+/* Centered Barrett reduction of both halves of a; v = round(2^26/q) */
+.macro barrett a, v, qqinv, t0, t1
+  smulbb \t0, \a, \v
+  smultb \t1, \a, \v
+  add \t0, \t0, #(1<<25)
+  add \t1, \t1, #(1<<25)
+  asr \t0, \t0, #26
+  asr \t1, \t1, #26
+  smulbb \t0, \t0, \qqinv
+  smulbb \t1, \t1, \qqinv
+  pkhbt \t0, \t0, \t1, lsl #16
+  sadd16 \a, \a, \t0
+.endm
+
+/* Three merged NTT layers on the words a0-a7: butterflies at distance 4, 2
+ * and 1 with the seven zetas at [ztab] */
+.macro ct_3layers a0, a1, a2, a3, a4, a5, a6, a7, ztab, zeta, qqinv, t0, t1
+  ldr \zeta, [\ztab, #0]
+  ct_butterfly \a0, \a4, \zeta, b, \qqinv, \t0, \t1
+  ct_butterfly \a1, \a5, \zeta, b, \qqinv, \t0, \t1
+  ct_butterfly \a2, \a6, \zeta, b, \qqinv, \t0, \t1
+  ct_butterfly \a3, \a7, \zeta, b, \qqinv, \t0, \t1
+
+  ct_butterfly \a0, \a2, \zeta, t, \qqinv, \t0, \t1
+  ct_butterfly \a1, \a3, \zeta, t, \qqinv, \t0, \t1
+  ldr \zeta, [\ztab, #4]
+  ct_butterfly \a4, \a6, \zeta, b, \qqinv, \t0, \t1
+  ct_butterfly \a5, \a7, \zeta, b, \qqinv, \t0, \t1
+
+  ct_butterfly \a0, \a1, \zeta, t, \qqinv, \t0, \t1
+  ldr \zeta, [\ztab, #8]
+  ct_butterfly \a2, \a3, \zeta, b, \qqinv, \t0, \t1
+  ct_butterfly \a4, \a5, \zeta, t, \qqinv, \t0, \t1
+  ldr \zeta, [\ztab, #12]
+  ct_butterfly \a6, \a7, \zeta, b, \qqinv, \t0, \t1
+.endm
+
+/* Three merged inverse layers on the words a0-a7: butterflies at distance
+ * 1, 2 and 4; with last=1 the final layer also multiplies by f */
+.macro gs_3layers a0, a1, a2, a3, a4, a5, a6, a7, ztab, zeta, qqinv, t0, t1, last
+  ldr \zeta, [\ztab, #0]
+  gs_butterfly \a0, \a1, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a2, \a3, \zeta, t, \qqinv, \t0, \t1
+  ldr \zeta, [\ztab, #4]
+  gs_butterfly \a4, \a5, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a6, \a7, \zeta, t, \qqinv, \t0, \t1
+
+  ldr \zeta, [\ztab, #8]
+  gs_butterfly \a0, \a2, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a1, \a3, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a4, \a6, \zeta, t, \qqinv, \t0, \t1
+  gs_butterfly \a5, \a7, \zeta, t, \qqinv, \t0, \t1
+
+  ldr \zeta, [\ztab, #12]
+.if \last
+  gs_butterfly_last \a0, \a4, \zeta, \qqinv, \t0, \t1
+  gs_butterfly_last \a1, \a5, \zeta, \qqinv, \t0, \t1
+  gs_butterfly_last \a2, \a6, \zeta, \qqinv, \t0, \t1
+  gs_butterfly_last \a3, \a7, \zeta, \qqinv, \t0, \t1
+.else
+  gs_butterfly \a0, \a4, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a1, \a5, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a2, \a6, \zeta, b, \qqinv, \t0, \t1
+  gs_butterfly \a3, \a7, \zeta, b, \qqinv, \t0, \t1
+.endif
+.endm
+
+/* Loads/stores the words at [ptr + k*stride], k = 0..7, into/from r2-r9 */
+.macro load8 ptr, stride
+  ldr r2, [\ptr, #0*\stride]
+  ldr r3, [\ptr, #1*\stride]
+  ldr r4, [\ptr, #2*\stride]
+  ldr r5, [\ptr, #3*\stride]
+  ldr r6, [\ptr, #4*\stride]
+  ldr r7, [\ptr, #5*\stride]
+  ldr r8, [\ptr, #6*\stride]
+  ldr r9, [\ptr, #7*\stride]
+.endm
+
+.macro store8 ptr, stride
+  str r2, [\ptr, #0*\stride]
+  str r3, [\ptr, #1*\stride]
+  str r4, [\ptr, #2*\stride]
+  str r5, [\ptr, #3*\stride]
+  str r6, [\ptr, #4*\stride]
+  str r7, [\ptr, #5*\stride]
+  str r8, [\ptr, #6*\stride]
+  str r9, [\ptr, #7*\stride]
+.endm
+
+
+/*
+ * Layers 4-7 of ntt_m4, entered with r0 = poly + 64 and r1 at the layer-1
+ * zetas as left by the loop over layers 1-3: layers 4-6 on each block of
+ * 32 coefficients (8 blocks, two pairs each), layer 7 on four groups of
+ * four coefficients at a time with the outputs Barrett reduced. Uses
+ * r2-r12, r14 and the word at [sp]
+ */
+.macro ntt_layers_4_7
+  /* layers 4-6 */
+  sub r0, r0, #64
+  add r1, r1, #16
+  add r10, r0, #512
+  str r10, [sp]
+2:
+  load8 r0, 8
+  ct_3layers r2, r3, r4, r5, r6, r7, r8, r9, r1, r14, r12, r10, r11
+  store8 r0, 8
+  add r0, r0, #4
+  load8 r0, 8
+  ct_3layers r2, r3, r4, r5, r6, r7, r8, r9, r1, r14, r12, r10, r11
+  store8 r0, 8
+  add r0, r0, #60
+  add r1, r1, #16
+  ldr r10, [sp]
+  cmp r0, r10
+  bne 2b
+
+  /* layer 7 */
+  sub r0, r0, #512
+3:
+  ldm r0, {r2-r9}
+  ldr r14, [r1], #4
+  ct_butterfly r2, r3, r14, b, r12, r10, r11
+  ct_butterfly r4, r5, r14, t, r12, r10, r11
+  ldr r14, [r1], #4
+  ct_butterfly r6, r7, r14, b, r12, r10, r11
+  ct_butterfly r8, r9, r14, t, r12, r10, r11
+  movw r14, #20159
+  barrett r2, r14, r12, r10, r11
+  barrett r3, r14, r12, r10, r11
+  barrett r4, r14, r12, r10, r11
+  barrett r5, r14, r12, r10, r11
+  barrett r6, r14, r12, r10, r11
+  barrett r7, r14, r12, r10, r11
+  barrett r8, r14, r12, r10, r11
+  barrett r9, r14, r12, r10, r11
+  stm r0!, {r2-r9}
+  ldr r10, [sp]
+  cmp r0, r10
+  bne 3b
+.endm
+
+/*
+ * Layers 1-4 of invntt_m4 on the polynomial at r0 with r1 at the zetas:
+ * layer 1 on groups of four, layers 2-4 per block of 32. Sums are Barrett
+ * reduced after layer 1 and after layer 4. Leaves r0 = poly + 512 and r1
+ * at the zetas of layers 5-7; uses r2-r12, r14 and the word at [sp]
+ */
+.macro invntt_layers_1_4
+  /* layer 1 */
+  add r10, r0, #512
+  str r10, [sp]
+1:
+  ldm r0, {r2-r9}
+  ldr r14, [r1], #4
+  gs_butterfly r2, r3, r14, b, r12, r10, r11
+  gs_butterfly r4, r5, r14, t, r12, r10, r11
+  ldr r14, [r1], #4
+  gs_butterfly r6, r7, r14, b, r12, r10, r11
+  gs_butterfly r8, r9, r14, t, r12, r10, r11
+  movw r14, #20159
+  barrett r2, r14, r12, r10, r11
+  barrett r4, r14, r12, r10, r11
+  barrett r6, r14, r12, r10, r11
+  barrett r8, r14, r12, r10, r11
+  stm r0!, {r2-r9}
+  ldr r10, [sp]
+  cmp r0, r10
+  bne 1b
+
+  /* layers 2-4 */
+  sub r0, r0, #512
+2:
+  load8 r0, 8
+  gs_3layers r2, r3, r4, r5, r6, r7, r8, r9, r1, r14, r12, r10, r11, 0
+  movw r14, #20159
+  barrett r2, r14, r12, r10, r11
+  barrett r3, r14, r12, r10, r11
+  barrett r4, r14, r12, r10, r11
+  barrett r5, r14, r12, r10, r11
+  store8 r0, 8
+  add r0, r0, #4
+  load8 r0, 8
+  gs_3layers r2, r3, r4, r5, r6, r7, r8, r9, r1, r14, r12, r10, r11, 0
+  movw r14, #20159
+  barrett r2, r14, r12, r10, r11
+  barrett r3, r14, r12, r10, r11
+  barrett r4, r14, r12, r10, r11
+  barrett r5, r14, r12, r10, r11
+  store8 r0, 8
+  add r0, r0, #60
+  add r1, r1, #16
+  ldr r10, [sp]
+  cmp r0, r10
+  bne 2b
+.endm
+
+#endif
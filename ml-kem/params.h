@@ -17,6 +17,13 @@
 #error "KYBER_K must be in {2,3,4}"
 #endif
 
+/* Code that does not depend on KYBER_K (NTT, reductions, sampling, ...)
+ * lives in a namespace shared by all parameter sets. A build that links
+ * several parameter sets into one image compiles it only once and builds
+ * the K-dependent code for the other sets with
+ * KYBER_MULTILEVEL_NO_SHARED defined, see the Makefile */
+#define KYBER_SHARED_NAMESPACE(s) pqcrystals_kyber_ref_##s
+
 #define KYBER_N 256
 #define KYBER_Q 3329
 
@@ -29,19 +36,21 @@
 #if KYBER_K == 2
 #define KYBER_ETA1 3
 #define KYBER_POLYCOMPRESSEDBYTES    128
-#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 320)
+#define KYBER_POLYCOMPRESSEDBYTES_DU 320
 #elif KYBER_K == 3
 #define KYBER_ETA1 2
 #define KYBER_POLYCOMPRESSEDBYTES    128
-#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 320)
+#define KYBER_POLYCOMPRESSEDBYTES_DU 320
 #elif KYBER_K == 4
 #define KYBER_ETA1 2
 #define KYBER_POLYCOMPRESSEDBYTES    160
-#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * 352)
+#define KYBER_POLYCOMPRESSEDBYTES_DU 352
 #endif
 
 #define KYBER_ETA2 2
 
+#define KYBER_POLYVECCOMPRESSEDBYTES (KYBER_K * KYBER_POLYCOMPRESSEDBYTES_DU)
+
 #define KYBER_INDCPA_MSGBYTES       (KYBER_SYMBYTES)
 #define KYBER_INDCPA_PUBLICKEYBYTES (KYBER_POLYVECBYTES + KYBER_SYMBYTES)
 #define KYBER_INDCPA_SECRETKEYBYTES (KYBER_POLYVECBYTES)
@@ -51,5 +60,7 @@
 /* 32 bytes of additional space to save H(pk) */
 #define KYBER_SECRETKEYBYTES  (KYBER_INDCPA_SECRETKEYBYTES + KYBER_INDCPA_PUBLICKEYBYTES + 2*KYBER_SYMBYTES)
 #define KYBER_CIPHERTEXTBYTES (KYBER_INDCPA_BYTES)
+/* seed-format private key (d, z), see kem_seed.h */
+#define KYBER_SEEDKEYBYTES    (2*KYBER_SYMBYTES)
 
 #endif
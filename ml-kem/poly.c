@@ -6,70 +6,222 @@
 #include "cbd.h"
 #include "symmetric.h"
 #include "verify.h"
+#include "debug.h"
 
 /*************************************************
-* Name:        poly_compress
+* Name:        compress_block
 *
-* Description: Compression and subsequent serialization of a polynomial
+* Description: Compression and subsequent serialization of 8 coefficients,
+*              the unit of poly_compress. Coefficients have to be in
+*              {-q+1,...,2q-1}
 *
 * Arguments:   - uint8_t *r: pointer to output byte array
-*                            (of length KYBER_POLYCOMPRESSEDBYTES)
-*              - const poly *a: pointer to input polynomial
+*                            (of length KYBER_POLYCOMPRESSEDBYTES/32)
+*              - const int16_t *a: pointer to 8 input coefficients
 **************************************************/
-void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a)
+static void compress_block(uint8_t r[KYBER_POLYCOMPRESSEDBYTES/32], const int16_t a[8])
 {
-  unsigned int i,j;
+  unsigned int j;
   int16_t u;
   uint32_t d0;
   uint8_t t[8];
 
 #if (KYBER_POLYCOMPRESSEDBYTES == 128)
-
-  for(i=0;i<KYBER_N/8;i++) {
-    for(j=0;j<8;j++) {
-      // map to positive standard representatives
-      u  = a->coeffs[8*i+j];
-      u += (u >> 15) & KYBER_Q;
-/*    t[j] = ((((uint16_t)u << 4) + KYBER_Q/2)/KYBER_Q) & 15; */
-      d0 = u << 4;
-      d0 += 1665;
-      d0 *= 80635;
-      d0 >>= 28;
-      t[j] = d0 & 0xf;
-    }
-
-    r[0] = t[0] | (t[1] << 4);
-    r[1] = t[2] | (t[3] << 4);
-    r[2] = t[4] | (t[5] << 4);
-    r[3] = t[6] | (t[7] << 4);
-    r += 4;
+  for(j=0;j<8;j++) {
+    // map to {0,...,2q-1}
+    u  = a[j];
+    u += (u >> 15) & KYBER_Q;
+/*  t[j] = ((((uint16_t)u << 4) + KYBER_Q/2)/KYBER_Q) & 15; */
+    d0 = u << 4;
+    d0 += 1665;
+    d0 *= 80635;
+    d0 >>= 28;
+    t[j] = d0 & 0xf;
   }
-#elif (KYBER_POLYCOMPRESSEDBYTES == 160)
-  for(i=0;i<KYBER_N/8;i++) {
-    for(j=0;j<8;j++) {
-      // map to positive standard representatives
-      u  = a->coeffs[8*i+j];
-      u += (u >> 15) & KYBER_Q;
-/*    t[j] = ((((uint32_t)u << 5) + KYBER_Q/2)/KYBER_Q) & 31; */
-      d0 = u << 5;
-      d0 += 1664;
-      d0 *= 40318;
-      d0 >>= 27;
-      t[j] = d0 & 0x1f;
-    }
 
-    r[0] = (t[0] >> 0) | (t[1] << 5);
-    r[1] = (t[1] >> 3) | (t[2] << 2) | (t[3] << 7);
-    r[2] = (t[3] >> 1) | (t[4] << 4);
-    r[3] = (t[4] >> 4) | (t[5] << 1) | (t[6] << 6);
-    r[4] = (t[6] >> 2) | (t[7] << 3);
-    r += 5;
+  r[0] = t[0] | (t[1] << 4);
+  r[1] = t[2] | (t[3] << 4);
+  r[2] = t[4] | (t[5] << 4);
+  r[3] = t[6] | (t[7] << 4);
+#elif (KYBER_POLYCOMPRESSEDBYTES == 160)
+  for(j=0;j<8;j++) {
+    // map to {0,...,2q-1}
+    u  = a[j];
+    u += (u >> 15) & KYBER_Q;
+/*  t[j] = ((((uint32_t)u << 5) + KYBER_Q/2)/KYBER_Q) & 31; */
+    d0 = u << 5;
+    d0 += 1664;
+    d0 *= 40318;
+    d0 >>= 27;
+    t[j] = d0 & 0x1f;
   }
+
+  r[0] = (t[0] >> 0) | (t[1] << 5);
+  r[1] = (t[1] >> 3) | (t[2] << 2) | (t[3] << 7);
+  r[2] = (t[3] >> 1) | (t[4] << 4);
+  r[3] = (t[4] >> 4) | (t[5] << 1) | (t[6] << 6);
+  r[4] = (t[6] >> 2) | (t[7] << 3);
 #else
 #error "KYBER_POLYCOMPRESSEDBYTES needs to be in {128, 160}"
 #endif
 }
 
+#if defined(__ARM_FEATURE_DSP)
+/*************************************************
+* Name:        poly_compress
+*
+* Description: Compression and subsequent serialization of a polynomial.
+*              Coefficients have to be in {-q+1,...,2q-1}; no prior
+*              reduction is needed. Cortex-M4 implementation in
+*              compress_m4.S
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a)
+{
+  debug_assert_bound(a->coeffs, KYBER_N, -KYBER_Q+1, 2*KYBER_Q);
+  poly_compress_m4(r, a->coeffs);
+}
+
+/*************************************************
+* Name:        poly_decompress
+*
+* Description: De-serialization and subsequent decompression of a polynomial;
+*              approximate inverse of poly_compress.
+*              Cortex-M4 implementation in compress_m4.S
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES bytes)
+**************************************************/
+void poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES])
+{
+  poly_decompress_m4(r->coeffs, a);
+}
+
+/*************************************************
+* Name:        poly_compress_du
+*
+* Description: Compress and serialize one polynomial of the vector u;
+*              coefficients have to be in {-q+1,...,q-1}.
+*              Cortex-M4 implementation in compress_m4.S
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYCOMPRESSEDBYTES_DU)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const poly *a)
+{
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+  poly_compress_du_m4(r, a->coeffs);
+}
+
+/*************************************************
+* Name:        poly_decompress_du
+*
+* Description: De-serialize and decompress one polynomial of the vector u;
+*              approximate inverse of poly_compress_du.
+*              Cortex-M4 implementation in compress_m4.S
+*
+* Arguments:   - poly *r:          pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES_DU)
+**************************************************/
+void poly_decompress_du(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+  poly_decompress_du_m4(r->coeffs, a);
+}
+#elif defined(__AVX2__)
+/*************************************************
+* Name:        poly_compress
+*
+* Description: Compression and subsequent serialization of a polynomial.
+*              Coefficients have to be in {-q+1,...,2q-1}; no prior
+*              reduction is needed. AVX2 implementation in
+*              compress_avx2.c
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a)
+{
+  debug_assert_bound(a->coeffs, KYBER_N, -KYBER_Q+1, 2*KYBER_Q);
+  poly_compress_avx2(r, a->coeffs);
+}
+
+/*************************************************
+* Name:        poly_decompress
+*
+* Description: De-serialization and subsequent decompression of a polynomial;
+*              approximate inverse of poly_compress.
+*              AVX2 implementation in compress_avx2.c
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES bytes)
+**************************************************/
+void poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES])
+{
+  poly_decompress_avx2(r->coeffs, a);
+}
+
+/*************************************************
+* Name:        poly_compress_du
+*
+* Description: Compress and serialize one polynomial of the vector u;
+*              coefficients have to be in {-q+1,...,q-1}.
+*              AVX2 implementation in compress_avx2.c
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYCOMPRESSEDBYTES_DU)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const poly *a)
+{
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+  poly_compress_du_avx2(r, a->coeffs);
+}
+
+/*************************************************
+* Name:        poly_decompress_du
+*
+* Description: De-serialize and decompress one polynomial of the vector u;
+*              approximate inverse of poly_compress_du.
+*              AVX2 implementation in compress_avx2.c
+*
+* Arguments:   - poly *r:          pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES_DU)
+**************************************************/
+void poly_decompress_du(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+  poly_decompress_du_avx2(r->coeffs, a);
+}
+#else
+/*************************************************
+* Name:        poly_compress
+*
+* Description: Compression and subsequent serialization of a polynomial.
+*              Coefficients have to be in {-q+1,...,2q-1}; the rounding
+*              below is exact on that range, so no prior reduction is needed
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a)
+{
+  unsigned int i;
+
+  debug_assert_bound(a->coeffs, KYBER_N, -KYBER_Q+1, 2*KYBER_Q);
+
+  for(i=0;i<KYBER_N/8;i++)
+    compress_block(r + i*(KYBER_POLYCOMPRESSEDBYTES/32), a->coeffs + 8*i);
+}
+
 /*************************************************
 * Name:        poly_decompress
 *
@@ -112,10 +264,246 @@ void poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES])
 #endif
 }
 
+/*************************************************
+* Name:        poly_compress_du
+*
+* Description: Compress and serialize one polynomial of the vector u;
+*              coefficients have to be in {-q+1,...,q-1}
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYCOMPRESSEDBYTES_DU)
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const poly *a)
+{
+  unsigned int j,k;
+  uint64_t d0;
+
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+
+#if (KYBER_POLYCOMPRESSEDBYTES_DU == 352)
+  uint16_t t[8];
+  for(j=0;j<KYBER_N/8;j++) {
+    for(k=0;k<8;k++) {
+      t[k]  = a->coeffs[8*j+k];
+      t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
+/*    t[k]  = ((((uint32_t)t[k] << 11) + KYBER_Q/2)/KYBER_Q) & 0x7ff; */
+      d0 = t[k];
+      d0 <<= 11;
+      d0 += 1664;
+      d0 *= 645084;
+      d0 >>= 31;
+      t[k] = d0 & 0x7ff;
+    }
+
+    r[ 0] = (t[0] >>  0);
+    r[ 1] = (t[0] >>  8) | (t[1] << 3);
+    r[ 2] = (t[1] >>  5) | (t[2] << 6);
+    r[ 3] = (t[2] >>  2);
+    r[ 4] = (t[2] >> 10) | (t[3] << 1);
+    r[ 5] = (t[3] >>  7) | (t[4] << 4);
+    r[ 6] = (t[4] >>  4) | (t[5] << 7);
+    r[ 7] = (t[5] >>  1);
+    r[ 8] = (t[5] >>  9) | (t[6] << 2);
+    r[ 9] = (t[6] >>  6) | (t[7] << 5);
+    r[10] = (t[7] >>  3);
+    r += 11;
+  }
+#elif (KYBER_POLYCOMPRESSEDBYTES_DU == 320)
+  uint16_t t[4];
+  for(j=0;j<KYBER_N/4;j++) {
+    for(k=0;k<4;k++) {
+      t[k]  = a->coeffs[4*j+k];
+      t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
+/*    t[k]  = ((((uint32_t)t[k] << 10) + KYBER_Q/2)/ KYBER_Q) & 0x3ff; */
+      d0 = t[k];
+      d0 <<= 10;
+      d0 += 1665;
+      d0 *= 1290167;
+      d0 >>= 32;
+      t[k] = d0 & 0x3ff;
+    }
+
+    r[0] = (t[0] >> 0);
+    r[1] = (t[0] >> 8) | (t[1] << 2);
+    r[2] = (t[1] >> 6) | (t[2] << 4);
+    r[3] = (t[2] >> 4) | (t[3] << 6);
+    r[4] = (t[3] >> 2);
+    r += 5;
+  }
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES_DU needs to be in {320, 352}"
+#endif
+}
+
+/*************************************************
+* Name:        poly_decompress_du
+*
+* Description: De-serialize and decompress one polynomial of the vector u;
+*              approximate inverse of poly_compress_du
+*
+* Arguments:   - poly *r:          pointer to output polynomial
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES_DU)
+**************************************************/
+void poly_decompress_du(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+  unsigned int j,k;
+
+#if (KYBER_POLYCOMPRESSEDBYTES_DU == 352)
+  uint16_t t[8];
+  for(j=0;j<KYBER_N/8;j++) {
+    t[0] = (a[0] >> 0) | ((uint16_t)a[ 1] << 8);
+    t[1] = (a[1] >> 3) | ((uint16_t)a[ 2] << 5);
+    t[2] = (a[2] >> 6) | ((uint16_t)a[ 3] << 2) | ((uint16_t)a[4] << 10);
+    t[3] = (a[4] >> 1) | ((uint16_t)a[ 5] << 7);
+    t[4] = (a[5] >> 4) | ((uint16_t)a[ 6] << 4);
+    t[5] = (a[6] >> 7) | ((uint16_t)a[ 7] << 1) | ((uint16_t)a[8] << 9);
+    t[6] = (a[8] >> 2) | ((uint16_t)a[ 9] << 6);
+    t[7] = (a[9] >> 5) | ((uint16_t)a[10] << 3);
+    a += 11;
+
+    for(k=0;k<8;k++)
+      r->coeffs[8*j+k] = ((uint32_t)(t[k] & 0x7FF)*KYBER_Q + 1024) >> 11;
+  }
+#elif (KYBER_POLYCOMPRESSEDBYTES_DU == 320)
+  uint16_t t[4];
+  for(j=0;j<KYBER_N/4;j++) {
+    t[0] = (a[0] >> 0) | ((uint16_t)a[1] << 8);
+    t[1] = (a[1] >> 2) | ((uint16_t)a[2] << 6);
+    t[2] = (a[2] >> 4) | ((uint16_t)a[3] << 4);
+    t[3] = (a[3] >> 6) | ((uint16_t)a[4] << 2);
+    a += 5;
+
+    for(k=0;k<4;k++)
+      r->coeffs[4*j+k] = ((uint32_t)(t[k] & 0x3FF)*KYBER_Q + 512) >> 10;
+  }
+#else
+#error "KYBER_POLYCOMPRESSEDBYTES_DU needs to be in {320, 352}"
+#endif
+}
+
+#endif
+
+/*************************************************
+* Name:        poly_compress_cmp
+*
+* Description: Compress a polynomial as poly_compress and compare the
+*              result with r in constant time. Compresses and compares
+*              8 coefficients at a time, so the compressed polynomial is
+*              never held in full
+*
+* Arguments:   - const uint8_t *r: pointer to byte array to compare with
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - const poly *a: pointer to input polynomial
+*
+* Returns 0 if the compressed polynomial equals r, 1 otherwise
+**************************************************/
+int poly_compress_cmp(const uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a)
+{
+  unsigned int i,j;
+  uint8_t t[KYBER_POLYCOMPRESSEDBYTES/32];
+  uint8_t d = 0;
+
+  debug_assert_bound(a->coeffs, KYBER_N, -KYBER_Q+1, 2*KYBER_Q);
+
+  for(i=0;i<KYBER_N/8;i++) {
+    compress_block(t, a->coeffs + 8*i);
+    for(j=0;j<KYBER_POLYCOMPRESSEDBYTES/32;j++)
+      d |= t[j] ^ r[j];
+    r += KYBER_POLYCOMPRESSEDBYTES/32;
+  }
+
+  return (-(uint64_t)d) >> 63;
+}
+
+/*************************************************
+* Name:        poly_decompress_du_ntt
+*
+* Description: poly_decompress_du followed by poly_ntt; on AVX2 and the
+*              Cortex-M4 the two are fused, so the decompressed polynomial
+*              is never stored
+*
+* Arguments:   - poly *r:          pointer to output polynomial (NTT domain)
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYCOMPRESSEDBYTES_DU)
+**************************************************/
+void poly_decompress_du_ntt(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU])
+{
+#if defined(__ARM_FEATURE_DSP)
+  poly_decompress_du_ntt_m4(r->coeffs, a, zetas_ntt_m4);
+  debug_assert_abs_bound(r->coeffs, KYBER_N, (KYBER_Q+1)/2);
+#elif defined(__AVX2__)
+  poly_decompress_du_ntt_avx2(r->coeffs, a);
+  debug_assert_abs_bound(r->coeffs, KYBER_N, (KYBER_Q+1)/2);
+#else
+  poly_decompress_du(r, a);
+  poly_ntt(r);
+#endif
+}
+
+/*************************************************
+* Name:        poly_invntt_add_compress_du
+*
+* Description: Computes poly_invntt_tomont(a), adds e and compresses the
+*              sum as poly_compress_du; on AVX2 and the Cortex-M4 the
+*              steps are fused, so the transform is never stored. The sum
+*              has to be in {-q+1,...,q-1}, so no reduction is needed
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (needs space for KYBER_POLYCOMPRESSEDBYTES_DU)
+*              - poly *a: pointer to input polynomial in NTT domain;
+*                         its contents are undefined afterwards
+*              - const poly *e: pointer to polynomial to add
+**************************************************/
+void poly_invntt_add_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], poly *a, const poly *e)
+{
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+#if defined(__ARM_FEATURE_DSP)
+  poly_invntt_add_compress_du_m4(r, a->coeffs, e->coeffs, zetas_invntt_m4);
+#elif defined(__AVX2__)
+  poly_invntt_add_compress_du_avx2(r, a->coeffs, e->coeffs);
+#else
+  poly_invntt_tomont(a);
+  poly_add(a, a, e);
+  poly_compress_du(r, a);
+#endif
+}
+
+/*************************************************
+* Name:        poly_invntt_add_compress
+*
+* Description: Computes poly_invntt_tomont(a), adds e and compresses the
+*              sum as poly_compress; on AVX2 and the Cortex-M4 the steps
+*              are fused, so the transform is never stored. The sum has to
+*              be in {-q+1,...,2q-1}, so no reduction is needed
+*
+* Arguments:   - uint8_t *r: pointer to output byte array
+*                            (of length KYBER_POLYCOMPRESSEDBYTES)
+*              - poly *a: pointer to input polynomial in NTT domain;
+*                         its contents are undefined afterwards
+*              - const poly *e: pointer to polynomial to add
+**************************************************/
+void poly_invntt_add_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], poly *a, const poly *e)
+{
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+#if defined(__ARM_FEATURE_DSP)
+  poly_invntt_add_compress_m4(r, a->coeffs, e->coeffs, zetas_invntt_m4);
+#elif defined(__AVX2__)
+  poly_invntt_add_compress_avx2(r, a->coeffs, e->coeffs);
+#else
+  poly_invntt_tomont(a);
+  poly_add(a, a, e);
+  poly_compress(r, a);
+#endif
+}
+
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
 /*************************************************
 * Name:        poly_tobytes
 *
-* Description: Serialization of a polynomial
+* Description: Serialization of a polynomial;
+*              coefficients have to be in {-q+1,...,q-1}
 *
 * Arguments:   - uint8_t *r: pointer to output byte array
 *                            (needs space for KYBER_POLYBYTES bytes)
@@ -126,6 +514,8 @@ void poly_tobytes(uint8_t r[KYBER_POLYBYTES], const poly *a)
   unsigned int i;
   uint16_t t0, t1;
 
+  debug_assert_abs_bound(a->coeffs, KYBER_N, KYBER_Q);
+
   for(i=0;i<KYBER_N/2;i++) {
     // map to positive standard representatives
     t0  = a->coeffs[2*i];
@@ -160,40 +550,54 @@ void poly_frombytes(poly *r, const uint8_t a[KYBER_POLYBYTES])
 /*************************************************
 * Name:        poly_frommsg
 *
-* Description: Convert 32-byte message to polynomial
+* Description: Convert 32-byte message to polynomial.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments:   - poly *r: pointer to output polynomial
 *              - const uint8_t *msg: pointer to input message
 **************************************************/
 void poly_frommsg(poly *r, const uint8_t msg[KYBER_INDCPA_MSGBYTES])
 {
-  unsigned int i,j;
-
 #if (KYBER_INDCPA_MSGBYTES != KYBER_N/8)
 #error "KYBER_INDCPA_MSGBYTES must be equal to KYBER_N/8 bytes!"
 #endif
 
+#if defined(__ARM_FEATURE_DSP)
+  poly_frommsg_m4(r->coeffs, msg);
+#else
+  unsigned int i,j;
+
   for(i=0;i<KYBER_N/8;i++) {
     for(j=0;j<8;j++) {
       r->coeffs[8*i+j] = 0;
       cmov_int16(r->coeffs+8*i+j, ((KYBER_Q+1)/2), (msg[i] >> j)&1);
     }
   }
+#endif
 }
 
 /*************************************************
 * Name:        poly_tomsg
 *
-* Description: Convert polynomial to 32-byte message
+* Description: Convert polynomial to 32-byte message;
+*              coefficients have to be in {-INVNTT_BOUND+1,...,2q-1},
+*              on which the rounding below is exact.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments:   - uint8_t *msg: pointer to output message
 *              - const poly *a: pointer to input polynomial
 **************************************************/
 void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *a)
 {
+#if defined(__ARM_FEATURE_DSP)
+  debug_assert_bound(a->coeffs, KYBER_N, -INVNTT_BOUND+1, 2*KYBER_Q);
+  poly_tomsg_m4(msg, a->coeffs);
+#else
   unsigned int i,j;
   uint32_t t;
 
+  debug_assert_bound(a->coeffs, KYBER_N, -INVNTT_BOUND+1, 2*KYBER_Q);
+
   for(i=0;i<KYBER_N/8;i++) {
     msg[i] = 0;
     for(j=0;j<8;j++) {
@@ -208,7 +612,9 @@ void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *a)
       msg[i] |= t << j;
     }
   }
+#endif
 }
+#endif
 
 /*************************************************
 * Name:        poly_getnoise_eta1
@@ -229,6 +635,7 @@ void poly_getnoise_eta1(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t non
   poly_cbd_eta1(r, buf);
 }
 
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
 /*************************************************
 * Name:        poly_getnoise_eta2
 *
@@ -254,14 +661,17 @@ void poly_getnoise_eta2(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t non
 *
 * Description: Computes negacyclic number-theoretic transform (NTT) of
 *              a polynomial in place;
-*              inputs assumed to be in normal order, output in bitreversed order
+*              inputs assumed to be in normal order, output in bitreversed order.
+*              Inputs have to be in {-q+1,...,q-1}, outputs are Barrett
+*              reduced to {-(q-1)/2,...,(q-1)/2}
 *
 * Arguments:   - uint16_t *r: pointer to in/output polynomial
 **************************************************/
 void poly_ntt(poly *r)
 {
+  debug_assert_abs_bound(r->coeffs, KYBER_N, KYBER_Q);
   ntt(r->coeffs);
-  poly_reduce(r);
+  debug_assert_abs_bound(r->coeffs, KYBER_N, (KYBER_Q+1)/2);
 }
 
 /*************************************************
@@ -269,13 +679,17 @@ void poly_ntt(poly *r)
 *
 * Description: Computes inverse of negacyclic number-theoretic transform (NTT)
 *              of a polynomial in place;
-*              inputs assumed to be in bitreversed order, output in normal order
+*              inputs assumed to be in bitreversed order, output in normal order.
+*              Inputs have to be in {-q+1,...,q-1}, outputs are in
+*              {-INVNTT_BOUND+1,...,INVNTT_BOUND-1}
 *
 * Arguments:   - uint16_t *a: pointer to in/output polynomial
 **************************************************/
 void poly_invntt_tomont(poly *r)
 {
+  debug_assert_abs_bound(r->coeffs, KYBER_N, KYBER_Q);
   invntt(r->coeffs);
+  debug_assert_abs_bound(r->coeffs, KYBER_N, INVNTT_BOUND);
 }
 
 /*************************************************
@@ -296,41 +710,75 @@ void poly_basemul_montgomery(poly *r, const poly *a, const poly *b)
   }
 }
 
+/*************************************************
+* Name:        poly_mulcache_compute
+*
+* Description: Computes the products of the odd coefficients of a polynomial
+*              in NTT domain with the zetas of the corresponding
+*              X^2-zeta factors, for use in polyvec_basemul_acc_montgomery_cached
+*
+* Arguments:   - poly_mulcache *x: pointer to output cache
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_mulcache_compute(poly_mulcache *x, const poly *a)
+{
+#if defined(__AVX2__)
+  poly_mulcache_compute_avx2(x, a);
+#else
+  unsigned int i;
+  for(i=0;i<KYBER_N/4;i++) {
+    x->coeffs[2*i]   = montgomery_reduce((int32_t)a->coeffs[4*i+1]*zetas[64+i]);
+    x->coeffs[2*i+1] = montgomery_reduce((int32_t)a->coeffs[4*i+3]*-zetas[64+i]);
+  }
+#endif
+}
+
 /*************************************************
 * Name:        poly_tomont
 *
 * Description: Inplace conversion of all coefficients of a polynomial
-*              from normal domain to Montgomery domain
+*              from normal domain to Montgomery domain.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments:   - poly *r: pointer to input/output polynomial
 **************************************************/
 void poly_tomont(poly *r)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_tomont_m4(r->coeffs, KYBER_N);
+#else
   unsigned int i;
   const int16_t f = (1ULL << 32) % KYBER_Q;
   for(i=0;i<KYBER_N;i++)
     r->coeffs[i] = montgomery_reduce((int32_t)r->coeffs[i]*f);
+#endif
 }
 
 /*************************************************
 * Name:        poly_reduce
 *
 * Description: Applies Barrett reduction to all coefficients of a polynomial
-*              for details of the Barrett reduction see comments in reduce.c
+*              for details of the Barrett reduction see comments in reduce.c.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments:   - poly *r: pointer to input/output polynomial
 **************************************************/
 void poly_reduce(poly *r)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_reduce_m4(r->coeffs, KYBER_N);
+#else
   unsigned int i;
   for(i=0;i<KYBER_N;i++)
     r->coeffs[i] = barrett_reduce(r->coeffs[i]);
+#endif
 }
 
 /*************************************************
 * Name:        poly_add
 *
-* Description: Add two polynomials; no modular reduction is performed
+* Description: Add two polynomials; no modular reduction is performed.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments: - poly *r: pointer to output polynomial
 *            - const poly *a: pointer to first input polynomial
@@ -338,15 +786,20 @@ void poly_reduce(poly *r)
 **************************************************/
 void poly_add(poly *r, const poly *a, const poly *b)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_add_m4(r->coeffs, a->coeffs, b->coeffs, KYBER_N);
+#else
   unsigned int i;
   for(i=0;i<KYBER_N;i++)
     r->coeffs[i] = a->coeffs[i] + b->coeffs[i];
+#endif
 }
 
 /*************************************************
 * Name:        poly_sub
 *
-* Description: Subtract two polynomials; no modular reduction is performed
+* Description: Subtract two polynomials; no modular reduction is performed.
+*              Cortex-M4 implementation in poly_m4.S
 *
 * Arguments: - poly *r:       pointer to output polynomial
 *            - const poly *a: pointer to first input polynomial
@@ -354,7 +807,12 @@ void poly_add(poly *r, const poly *a, const poly *b)
 **************************************************/
 void poly_sub(poly *r, const poly *a, const poly *b)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_sub_m4(r->coeffs, a->coeffs, b->coeffs, KYBER_N);
+#else
   unsigned int i;
   for(i=0;i<KYBER_N;i++)
     r->coeffs[i] = a->coeffs[i] - b->coeffs[i];
+#endif
 }
+#endif
@@ -12,42 +12,133 @@ typedef struct{
   int16_t coeffs[KYBER_N];
 } poly;
 
+/*
+ * Cache of the products b[2i+1]*zeta_i needed by the base multiplication
+ * with b; computed once for a polynomial that is multiplied several times
+ */
+typedef struct{
+  int16_t coeffs[KYBER_N/2];
+} poly_mulcache;
+
 #define poly_compress KYBER_NAMESPACE(poly_compress)
 void poly_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a);
 #define poly_decompress KYBER_NAMESPACE(poly_decompress)
 void poly_decompress(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+#define poly_compress_du KYBER_NAMESPACE(poly_compress_du)
+void poly_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const poly *a);
+#define poly_decompress_du KYBER_NAMESPACE(poly_decompress_du)
+void poly_decompress_du(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU]);
+#define poly_compress_cmp KYBER_NAMESPACE(poly_compress_cmp)
+int poly_compress_cmp(const uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const poly *a);
+#define poly_decompress_du_ntt KYBER_NAMESPACE(poly_decompress_du_ntt)
+void poly_decompress_du_ntt(poly *r, const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU]);
+#define poly_invntt_add_compress_du KYBER_NAMESPACE(poly_invntt_add_compress_du)
+void poly_invntt_add_compress_du(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], poly *a, const poly *e);
+#define poly_invntt_add_compress KYBER_NAMESPACE(poly_invntt_add_compress)
+void poly_invntt_add_compress(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], poly *a, const poly *e);
 
-#define poly_tobytes KYBER_NAMESPACE(poly_tobytes)
+#if defined(__ARM_FEATURE_DSP)
+#define poly_compress_m4 KYBER_NAMESPACE(poly_compress_m4)
+void poly_compress_m4(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const int16_t a[KYBER_N]);
+#define poly_decompress_m4 KYBER_NAMESPACE(poly_decompress_m4)
+void poly_decompress_m4(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+#define poly_compress_du_m4 KYBER_NAMESPACE(poly_compress_du_m4)
+void poly_compress_du_m4(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const int16_t a[KYBER_N]);
+#define poly_decompress_du_m4 KYBER_NAMESPACE(poly_decompress_du_m4)
+void poly_decompress_du_m4(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU]);
+#define poly_decompress_du_ntt_m4 KYBER_NAMESPACE(poly_decompress_du_ntt_m4)
+void poly_decompress_du_ntt_m4(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU],
+                               const int16_t zetas[136]);
+#define poly_invntt_add_compress_du_m4 KYBER_NAMESPACE(poly_invntt_add_compress_du_m4)
+void poly_invntt_add_compress_du_m4(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU],
+                                    int16_t a[KYBER_N],
+                                    const int16_t e[KYBER_N],
+                                    const int16_t zetas[136]);
+#define poly_invntt_add_compress_m4 KYBER_NAMESPACE(poly_invntt_add_compress_m4)
+void poly_invntt_add_compress_m4(uint8_t r[KYBER_POLYCOMPRESSEDBYTES],
+                                 int16_t a[KYBER_N],
+                                 const int16_t e[KYBER_N],
+                                 const int16_t zetas[136]);
+#elif defined(__AVX2__)
+#define poly_compress_avx2 KYBER_NAMESPACE(poly_compress_avx2)
+void poly_compress_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES], const int16_t a[KYBER_N]);
+#define poly_decompress_avx2 KYBER_NAMESPACE(poly_decompress_avx2)
+void poly_decompress_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES]);
+#define poly_compress_du_avx2 KYBER_NAMESPACE(poly_compress_du_avx2)
+void poly_compress_du_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU], const int16_t a[KYBER_N]);
+#define poly_decompress_du_avx2 KYBER_NAMESPACE(poly_decompress_du_avx2)
+void poly_decompress_du_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU]);
+#define poly_decompress_du_ntt_avx2 KYBER_NAMESPACE(poly_decompress_du_ntt_avx2)
+void poly_decompress_du_ntt_avx2(int16_t r[KYBER_N], const uint8_t a[KYBER_POLYCOMPRESSEDBYTES_DU]);
+#define poly_invntt_add_compress_du_avx2 KYBER_NAMESPACE(poly_invntt_add_compress_du_avx2)
+void poly_invntt_add_compress_du_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES_DU],
+                                      const int16_t a[KYBER_N],
+                                      const int16_t e[KYBER_N]);
+#define poly_invntt_add_compress_avx2 KYBER_NAMESPACE(poly_invntt_add_compress_avx2)
+void poly_invntt_add_compress_avx2(uint8_t r[KYBER_POLYCOMPRESSEDBYTES],
+                                   const int16_t a[KYBER_N],
+                                   const int16_t e[KYBER_N]);
+#endif
+
+#define poly_tobytes KYBER_SHARED_NAMESPACE(poly_tobytes)
 void poly_tobytes(uint8_t r[KYBER_POLYBYTES], const poly *a);
-#define poly_frombytes KYBER_NAMESPACE(poly_frombytes)
+#define poly_frombytes KYBER_SHARED_NAMESPACE(poly_frombytes)
 void poly_frombytes(poly *r, const uint8_t a[KYBER_POLYBYTES]);
 
-#define poly_frommsg KYBER_NAMESPACE(poly_frommsg)
+#define poly_frommsg KYBER_SHARED_NAMESPACE(poly_frommsg)
 void poly_frommsg(poly *r, const uint8_t msg[KYBER_INDCPA_MSGBYTES]);
-#define poly_tomsg KYBER_NAMESPACE(poly_tomsg)
+#define poly_tomsg KYBER_SHARED_NAMESPACE(poly_tomsg)
 void poly_tomsg(uint8_t msg[KYBER_INDCPA_MSGBYTES], const poly *r);
 
 #define poly_getnoise_eta1 KYBER_NAMESPACE(poly_getnoise_eta1)
 void poly_getnoise_eta1(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
 
-#define poly_getnoise_eta2 KYBER_NAMESPACE(poly_getnoise_eta2)
+#define poly_getnoise_eta2 KYBER_SHARED_NAMESPACE(poly_getnoise_eta2)
 void poly_getnoise_eta2(poly *r, const uint8_t seed[KYBER_SYMBYTES], uint8_t nonce);
 
-#define poly_ntt KYBER_NAMESPACE(poly_ntt)
+#define poly_ntt KYBER_SHARED_NAMESPACE(poly_ntt)
 void poly_ntt(poly *r);
-#define poly_invntt_tomont KYBER_NAMESPACE(poly_invntt_tomont)
+#define poly_invntt_tomont KYBER_SHARED_NAMESPACE(poly_invntt_tomont)
 void poly_invntt_tomont(poly *r);
-#define poly_basemul_montgomery KYBER_NAMESPACE(poly_basemul_montgomery)
+#define poly_basemul_montgomery KYBER_SHARED_NAMESPACE(poly_basemul_montgomery)
 void poly_basemul_montgomery(poly *r, const poly *a, const poly *b);
-#define poly_tomont KYBER_NAMESPACE(poly_tomont)
+#define poly_mulcache_compute KYBER_SHARED_NAMESPACE(poly_mulcache_compute)
+void poly_mulcache_compute(poly_mulcache *x, const poly *a);
+#if defined(__AVX2__)
+#define poly_mulcache_compute_avx2 KYBER_SHARED_NAMESPACE(poly_mulcache_compute_avx2)
+void poly_mulcache_compute_avx2(poly_mulcache *x, const poly *a);
+#define poly_basemul_acc_avx2 KYBER_SHARED_NAMESPACE(poly_basemul_acc_avx2)
+void poly_basemul_acc_avx2(poly *r,
+                           const poly *a,
+                           const poly *b,
+                           const poly_mulcache *b_cache,
+                           unsigned int k,
+                           const poly *e);
+#endif
+#define poly_tomont KYBER_SHARED_NAMESPACE(poly_tomont)
 void poly_tomont(poly *r);
 
-#define poly_reduce KYBER_NAMESPACE(poly_reduce)
+#define poly_reduce KYBER_SHARED_NAMESPACE(poly_reduce)
 void poly_reduce(poly *r);
 
-#define poly_add KYBER_NAMESPACE(poly_add)
+#define poly_add KYBER_SHARED_NAMESPACE(poly_add)
 void poly_add(poly *r, const poly *a, const poly *b);
-#define poly_sub KYBER_NAMESPACE(poly_sub)
+#define poly_sub KYBER_SHARED_NAMESPACE(poly_sub)
 void poly_sub(poly *r, const poly *a, const poly *b);
 
+#if defined(__ARM_FEATURE_DSP)
+#define poly_add_m4 KYBER_SHARED_NAMESPACE(poly_add_m4)
+void poly_add_m4(int16_t *r, const int16_t *a, const int16_t *b, unsigned int n);
+#define poly_sub_m4 KYBER_SHARED_NAMESPACE(poly_sub_m4)
+void poly_sub_m4(int16_t *r, const int16_t *a, const int16_t *b, unsigned int n);
+#define poly_reduce_m4 KYBER_SHARED_NAMESPACE(poly_reduce_m4)
+void poly_reduce_m4(int16_t *r, unsigned int n);
+#define poly_tomont_m4 KYBER_SHARED_NAMESPACE(poly_tomont_m4)
+void poly_tomont_m4(int16_t *r, unsigned int n);
+#define poly_frommsg_m4 KYBER_SHARED_NAMESPACE(poly_frommsg_m4)
+void poly_frommsg_m4(int16_t r[KYBER_N], const uint8_t msg[KYBER_INDCPA_MSGBYTES]);
+#define poly_tomsg_m4 KYBER_SHARED_NAMESPACE(poly_tomsg_m4)
+void poly_tomsg_m4(uint8_t msg[KYBER_INDCPA_MSGBYTES], const int16_t a[KYBER_N]);
+#endif
+
 #endif
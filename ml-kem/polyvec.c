@@ -1,12 +1,16 @@
+#include <stddef.h>
 #include <stdint.h>
 #include "params.h"
 #include "poly.h"
 #include "polyvec.h"
+#include "reduce.h"
+#include "debug.h"
 
 /*************************************************
 * Name:        polyvec_compress
 *
-* Description: Compress and serialize vector of polynomials
+* Description: Compress and serialize vector of polynomials;
+*              coefficients have to be in {-q+1,...,q-1}
 *
 * Arguments:   - uint8_t *r: pointer to output byte array
 *                            (needs space for KYBER_POLYVECCOMPRESSEDBYTES)
@@ -14,66 +18,9 @@
 **************************************************/
 void polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a)
 {
-  unsigned int i,j,k;
-  uint64_t d0;
-
-#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
-  uint16_t t[8];
-  for(i=0;i<KYBER_K;i++) {
-    for(j=0;j<KYBER_N/8;j++) {
-      for(k=0;k<8;k++) {
-        t[k]  = a->vec[i].coeffs[8*j+k];
-        t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
-/*      t[k]  = ((((uint32_t)t[k] << 11) + KYBER_Q/2)/KYBER_Q) & 0x7ff; */
-        d0 = t[k];
-        d0 <<= 11;
-        d0 += 1664;
-        d0 *= 645084;
-        d0 >>= 31;
-        t[k] = d0 & 0x7ff;
-      }
-
-      r[ 0] = (t[0] >>  0);
-      r[ 1] = (t[0] >>  8) | (t[1] << 3);
-      r[ 2] = (t[1] >>  5) | (t[2] << 6);
-      r[ 3] = (t[2] >>  2);
-      r[ 4] = (t[2] >> 10) | (t[3] << 1);
-      r[ 5] = (t[3] >>  7) | (t[4] << 4);
-      r[ 6] = (t[4] >>  4) | (t[5] << 7);
-      r[ 7] = (t[5] >>  1);
-      r[ 8] = (t[5] >>  9) | (t[6] << 2);
-      r[ 9] = (t[6] >>  6) | (t[7] << 5);
-      r[10] = (t[7] >>  3);
-      r += 11;
-    }
-  }
-#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
-  uint16_t t[4];
-  for(i=0;i<KYBER_K;i++) {
-    for(j=0;j<KYBER_N/4;j++) {
-      for(k=0;k<4;k++) {
-        t[k]  = a->vec[i].coeffs[4*j+k];
-        t[k] += ((int16_t)t[k] >> 15) & KYBER_Q;
-/*      t[k]  = ((((uint32_t)t[k] << 10) + KYBER_Q/2)/ KYBER_Q) & 0x3ff; */
-        d0 = t[k];
-        d0 <<= 10;
-        d0 += 1665;
-        d0 *= 1290167;
-        d0 >>= 32;
-        t[k] = d0 & 0x3ff;
-      }
-
-      r[0] = (t[0] >> 0);
-      r[1] = (t[0] >> 8) | (t[1] << 2);
-      r[2] = (t[1] >> 6) | (t[2] << 4);
-      r[3] = (t[2] >> 4) | (t[3] << 6);
-      r[4] = (t[3] >> 2);
-      r += 5;
-    }
-  }
-#else
-#error "KYBER_POLYVECCOMPRESSEDBYTES needs to be in {320*KYBER_K, 352*KYBER_K}"
-#endif
+  unsigned int i;
+  for(i=0;i<KYBER_K;i++)
+    poly_compress_du(r+i*KYBER_POLYCOMPRESSEDBYTES_DU, &a->vec[i]);
 }
 
 /*************************************************
@@ -88,43 +35,27 @@ void polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a)
 **************************************************/
 void polyvec_decompress(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES])
 {
-  unsigned int i,j,k;
+  unsigned int i;
+  for(i=0;i<KYBER_K;i++)
+    poly_decompress_du(&r->vec[i], a+i*KYBER_POLYCOMPRESSEDBYTES_DU);
+}
 
-#if (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 352))
-  uint16_t t[8];
-  for(i=0;i<KYBER_K;i++) {
-    for(j=0;j<KYBER_N/8;j++) {
-      t[0] = (a[0] >> 0) | ((uint16_t)a[ 1] << 8);
-      t[1] = (a[1] >> 3) | ((uint16_t)a[ 2] << 5);
-      t[2] = (a[2] >> 6) | ((uint16_t)a[ 3] << 2) | ((uint16_t)a[4] << 10);
-      t[3] = (a[4] >> 1) | ((uint16_t)a[ 5] << 7);
-      t[4] = (a[5] >> 4) | ((uint16_t)a[ 6] << 4);
-      t[5] = (a[6] >> 7) | ((uint16_t)a[ 7] << 1) | ((uint16_t)a[8] << 9);
-      t[6] = (a[8] >> 2) | ((uint16_t)a[ 9] << 6);
-      t[7] = (a[9] >> 5) | ((uint16_t)a[10] << 3);
-      a += 11;
-
-      for(k=0;k<8;k++)
-        r->vec[i].coeffs[8*j+k] = ((uint32_t)(t[k] & 0x7FF)*KYBER_Q + 1024) >> 11;
-    }
-  }
-#elif (KYBER_POLYVECCOMPRESSEDBYTES == (KYBER_K * 320))
-  uint16_t t[4];
-  for(i=0;i<KYBER_K;i++) {
-    for(j=0;j<KYBER_N/4;j++) {
-      t[0] = (a[0] >> 0) | ((uint16_t)a[1] << 8);
-      t[1] = (a[1] >> 2) | ((uint16_t)a[2] << 6);
-      t[2] = (a[2] >> 4) | ((uint16_t)a[3] << 4);
-      t[3] = (a[3] >> 6) | ((uint16_t)a[4] << 2);
-      a += 5;
-
-      for(k=0;k<4;k++)
-        r->vec[i].coeffs[4*j+k] = ((uint32_t)(t[k] & 0x3FF)*KYBER_Q + 512) >> 10;
-    }
-  }
-#else
-#error "KYBER_POLYVECCOMPRESSEDBYTES needs to be in {320*KYBER_K, 352*KYBER_K}"
-#endif
+/*************************************************
+* Name:        polyvec_decompress_ntt
+*
+* Description: De-serialize and decompress vector of polynomials and
+*              transform it to NTT domain; same as polyvec_decompress
+*              followed by polyvec_ntt
+*
+* Arguments:   - polyvec *r:       pointer to output vector of polynomials
+*              - const uint8_t *a: pointer to input byte array
+*                                  (of length KYBER_POLYVECCOMPRESSEDBYTES)
+**************************************************/
+void polyvec_decompress_ntt(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES])
+{
+  unsigned int i;
+  for(i=0;i<KYBER_K;i++)
+    poly_decompress_du_ntt(&r->vec[i], a+i*KYBER_POLYCOMPRESSEDBYTES_DU);
 }
 
 /*************************************************
@@ -190,27 +121,177 @@ void polyvec_invntt_tomont(polyvec *r)
 }
 
 /*************************************************
-* Name:        polyvec_basemul_acc_montgomery
+* Name:        polyvec_mulcache_compute
+*
+* Description: Apply poly_mulcache_compute to all elements of a vector
+*              of polynomials
+*
+* Arguments: - polyvec_mulcache *x: pointer to output cache
+*            - const polyvec *a: pointer to input vector of polynomials
+**************************************************/
+void polyvec_mulcache_compute(polyvec_mulcache *x, const polyvec *a)
+{
+  unsigned int i;
+  for(i=0;i<KYBER_K;i++)
+    poly_mulcache_compute(&x->vec[i], &a->vec[i]);
+}
+
+#if !defined(__AVX2__)
+/*************************************************
+* Name:        basemul_acc_cached
+*
+* Description: Accumulates the products of the coefficient pair i of all
+*              elements of a and b in NTT domain in 32 bits, without
+*              reduction; the products of b with the zetas are taken from
+*              b_cache. Requires |a| < 2^12 and |b|, |b_cache| < q,
+*              which keeps |t| below K*2^13*q <= q*2^15
+*
+* Arguments: - int32_t t[2]: output accumulators
+*            - const polyvec *a: pointer to first input vector of polynomials
+*            - const polyvec *b: pointer to second input vector of polynomials
+*            - const polyvec_mulcache *b_cache: cache computed from b
+*            - unsigned int i: index of the coefficient pair
+**************************************************/
+static void basemul_acc_cached(int32_t t[2],
+                               const polyvec *a,
+                               const polyvec *b,
+                               const polyvec_mulcache *b_cache,
+                               unsigned int i)
+{
+  unsigned int j;
+  const int16_t *x, *y;
+
+  t[0] = t[1] = 0;
+  for(j=0;j<KYBER_K;j++) {
+    x = &a->vec[j].coeffs[2*i];
+    y = &b->vec[j].coeffs[2*i];
+    t[0] += (int32_t)x[0]*y[0];
+    t[0] += (int32_t)x[1]*b_cache->vec[j].coeffs[i];
+    t[1] += (int32_t)x[0]*y[1];
+    t[1] += (int32_t)x[1]*y[0];
+  }
+}
+#endif
+
+/*************************************************
+* Name:        check_basemul_bounds
+*
+* Description: Asserts the input bounds of the cached base multiplication
+*              in debug builds (see basemul_acc_cached)
+**************************************************/
+static void check_basemul_bounds(const polyvec *a, const polyvec *b, const polyvec_mulcache *b_cache)
+{
+  unsigned int i;
+  for(i=0;i<KYBER_K;i++) {
+    debug_assert_abs_bound(a->vec[i].coeffs, KYBER_N, 4096);
+    debug_assert_abs_bound(b->vec[i].coeffs, KYBER_N, KYBER_Q);
+    debug_assert_abs_bound(b_cache->vec[i].coeffs, KYBER_N/2, KYBER_Q);
+  }
+  (void)a; (void)b; (void)b_cache;
+}
+
+/*************************************************
+* Name:        polyvec_basemul_acc_montgomery_cached
 *
 * Description: Multiply elements of a and b in NTT domain, accumulate into r,
-*              and multiply by 2^-16.
+*              and multiply by 2^-16. Products are accumulated in 32 bits
+*              over all K elements and reduced once per coefficient; the
+*              products of b with the zetas are taken from b_cache.
+*              Requires |a| < 2^12 and |b|, |b_cache| < q;
+*              output is in {-q+1,...,q-1}. With AVX2 the work is done by
+*              poly_basemul_acc_avx2 (ntt_avx2.c) with the same results.
 *
 * Arguments: - poly *r: pointer to output polynomial
 *            - const polyvec *a: pointer to first input vector of polynomials
 *            - const polyvec *b: pointer to second input vector of polynomials
+*            - const polyvec_mulcache *b_cache: cache computed from b
 **************************************************/
-void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b)
+void polyvec_basemul_acc_montgomery_cached(poly *r,
+                                           const polyvec *a,
+                                           const polyvec *b,
+                                           const polyvec_mulcache *b_cache)
 {
+#if defined(__AVX2__)
+  check_basemul_bounds(a, b, b_cache);
+  poly_basemul_acc_avx2(r, a->vec, b->vec, b_cache->vec, KYBER_K, NULL);
+#else
   unsigned int i;
-  poly t;
+  int32_t t[2];
 
-  poly_basemul_montgomery(r, &a->vec[0], &b->vec[0]);
-  for(i=1;i<KYBER_K;i++) {
-    poly_basemul_montgomery(&t, &a->vec[i], &b->vec[i]);
-    poly_add(r, r, &t);
+  check_basemul_bounds(a, b, b_cache);
+  for(i=0;i<KYBER_N/2;i++) {
+    basemul_acc_cached(t, a, b, b_cache, i);
+    r->coeffs[2*i]   = montgomery_reduce(t[0]);
+    r->coeffs[2*i+1] = montgomery_reduce(t[1]);
   }
+#endif
+}
 
-  poly_reduce(r);
+/*************************************************
+* Name:        polyvec_basemul_acc_add_cached
+*
+* Description: Computes r = a^T*b + e in NTT domain with r in normal
+*              (not Montgomery) domain: the accumulated products are
+*              Montgomery reduced once and then multiplied by 2^32 mod q
+*              in the same reduction that adds e (times 2^16 mod q). This
+*              replaces polyvec_basemul_acc_montgomery_cached followed by
+*              poly_tomont, poly_add and poly_reduce.
+*              Requires a, b, b_cache as for
+*              polyvec_basemul_acc_montgomery_cached and |e| < q;
+*              output is in {-q+1,...,q-1}.
+*
+* Arguments: - poly *r: pointer to output polynomial
+*            - const polyvec *a: pointer to first input vector of polynomials
+*            - const polyvec *b: pointer to second input vector of polynomials
+*            - const polyvec_mulcache *b_cache: cache computed from b
+*            - const poly *e: pointer to polynomial to add
+**************************************************/
+void polyvec_basemul_acc_add_cached(poly *r,
+                                    const polyvec *a,
+                                    const polyvec *b,
+                                    const polyvec_mulcache *b_cache,
+                                    const poly *e)
+{
+#if defined(__AVX2__)
+  check_basemul_bounds(a, b, b_cache);
+  debug_assert_abs_bound(e->coeffs, KYBER_N, KYBER_Q);
+  poly_basemul_acc_avx2(r, a->vec, b->vec, b_cache->vec, KYBER_K, e);
+#else
+  unsigned int i, j;
+  int32_t t[2];
+  int16_t u;
+  const int16_t f = (1ULL << 32) % KYBER_Q;
+
+  check_basemul_bounds(a, b, b_cache);
+  debug_assert_abs_bound(e->coeffs, KYBER_N, KYBER_Q);
+  for(i=0;i<KYBER_N/2;i++) {
+    basemul_acc_cached(t, a, b, b_cache, i);
+    for(j=0;j<2;j++) {
+      u = montgomery_reduce(t[j]);
+      r->coeffs[2*i+j] = montgomery_reduce((int32_t)u*f + (int32_t)e->coeffs[2*i+j]*MONT);
+    }
+  }
+#endif
+}
+
+/*************************************************
+* Name:        polyvec_basemul_acc_montgomery
+*
+* Description: Multiply elements of a and b in NTT domain, accumulate into r,
+*              and multiply by 2^-16. Same as
+*              polyvec_basemul_acc_montgomery_cached with the cache
+*              computed on the fly; use that for b that is used repeatedly.
+*
+* Arguments: - poly *r: pointer to output polynomial
+*            - const polyvec *a: pointer to first input vector of polynomials
+*            - const polyvec *b: pointer to second input vector of polynomials
+**************************************************/
+void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b)
+{
+  polyvec_mulcache b_cache;
+
+  polyvec_mulcache_compute(&b_cache, b);
+  polyvec_basemul_acc_montgomery_cached(r, a, b, &b_cache);
 }
 
 /*************************************************
@@ -218,21 +299,27 @@ void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b)
 *
 * Description: Applies Barrett reduction to each coefficient
 *              of each element of a vector of polynomials;
-*              for details of the Barrett reduction see comments in reduce.c
+*              for details of the Barrett reduction see comments in reduce.c.
+*              On the Cortex-M4 the whole vector is reduced in one call
 *
 * Arguments:   - polyvec *r: pointer to input/output polynomial
 **************************************************/
 void polyvec_reduce(polyvec *r)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_reduce_m4(r->vec[0].coeffs, KYBER_K*KYBER_N);
+#else
   unsigned int i;
   for(i=0;i<KYBER_K;i++)
     poly_reduce(&r->vec[i]);
+#endif
 }
 
 /*************************************************
 * Name:        polyvec_add
 *
-* Description: Add vectors of polynomials
+* Description: Add vectors of polynomials;
+*              on the Cortex-M4 in one call for the whole vector
 *
 * Arguments: - polyvec *r: pointer to output vector of polynomials
 *            - const polyvec *a: pointer to first input vector of polynomials
@@ -240,7 +327,11 @@ void polyvec_reduce(polyvec *r)
 **************************************************/
 void polyvec_add(polyvec *r, const polyvec *a, const polyvec *b)
 {
+#if defined(__ARM_FEATURE_DSP)
+  poly_add_m4(r->vec[0].coeffs, a->vec[0].coeffs, b->vec[0].coeffs, KYBER_K*KYBER_N);
+#else
   unsigned int i;
   for(i=0;i<KYBER_K;i++)
     poly_add(&r->vec[i], &a->vec[i], &b->vec[i]);
+#endif
 }
@@ -9,10 +9,16 @@ typedef struct{
   poly vec[KYBER_K];
 } polyvec;
 
+typedef struct{
+  poly_mulcache vec[KYBER_K];
+} polyvec_mulcache;
+
 #define polyvec_compress KYBER_NAMESPACE(polyvec_compress)
 void polyvec_compress(uint8_t r[KYBER_POLYVECCOMPRESSEDBYTES], const polyvec *a);
 #define polyvec_decompress KYBER_NAMESPACE(polyvec_decompress)
 void polyvec_decompress(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]);
+#define polyvec_decompress_ntt KYBER_NAMESPACE(polyvec_decompress_ntt)
+void polyvec_decompress_ntt(polyvec *r, const uint8_t a[KYBER_POLYVECCOMPRESSEDBYTES]);
 
 #define polyvec_tobytes KYBER_NAMESPACE(polyvec_tobytes)
 void polyvec_tobytes(uint8_t r[KYBER_POLYVECBYTES], const polyvec *a);
@@ -24,8 +30,22 @@ void polyvec_ntt(polyvec *r);
 #define polyvec_invntt_tomont KYBER_NAMESPACE(polyvec_invntt_tomont)
 void polyvec_invntt_tomont(polyvec *r);
 
+#define polyvec_mulcache_compute KYBER_NAMESPACE(polyvec_mulcache_compute)
+void polyvec_mulcache_compute(polyvec_mulcache *x, const polyvec *a);
+
 #define polyvec_basemul_acc_montgomery KYBER_NAMESPACE(polyvec_basemul_acc_montgomery)
 void polyvec_basemul_acc_montgomery(poly *r, const polyvec *a, const polyvec *b);
+#define polyvec_basemul_acc_montgomery_cached KYBER_NAMESPACE(polyvec_basemul_acc_montgomery_cached)
+void polyvec_basemul_acc_montgomery_cached(poly *r,
+                                           const polyvec *a,
+                                           const polyvec *b,
+                                           const polyvec_mulcache *b_cache);
+#define polyvec_basemul_acc_add_cached KYBER_NAMESPACE(polyvec_basemul_acc_add_cached)
+void polyvec_basemul_acc_add_cached(poly *r,
+                                    const polyvec *a,
+                                    const polyvec *b,
+                                    const polyvec_mulcache *b_cache,
+                                    const poly *e);
 
 #define polyvec_reduce KYBER_NAMESPACE(polyvec_reduce)
 void polyvec_reduce(polyvec *r);
@@ -0,0 +1,16 @@
+#ifndef REJSAMPLE_H
+#define REJSAMPLE_H
+
+#include <stdint.h>
+#include "params.h"
+
+#if defined(__AVX2__)
+#define rej_uniform_avx2 KYBER_SHARED_NAMESPACE(rej_uniform_avx2)
+unsigned int rej_uniform_avx2(int16_t *r,
+                              unsigned int len,
+                              const uint8_t *buf,
+                              unsigned int buflen,
+                              unsigned int *pos);
+#endif
+
+#endif
@@ -0,0 +1,340 @@
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include <stdint.h>
+#include "params.h"
+#include "rejsample.h"
+
+/*
+ * Compaction table of rej_uniform_avx2: for every 8-bit mask of accepted
+ * candidates, the indices of the accepted ones in ascending order, padded
+ * with 255 (which makes VPSHUFB write zeros). Generated by
+ *
+ *   for m in range(256):
+ *       l = [i for i in range(8) if m >> i & 1]
+ *       print(l + [255]*(8-len(l)))
+ */
+static const uint8_t rej_idx[256][8] = {
+  {255, 255, 255, 255, 255, 255, 255, 255},
+  {  0, 255, 255, 255, 255, 255, 255, 255},
+  {  1, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   1, 255, 255, 255, 255, 255, 255},
+  {  2, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   2, 255, 255, 255, 255, 255, 255},
+  {  1,   2, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   2, 255, 255, 255, 255, 255},
+  {  3, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   3, 255, 255, 255, 255, 255, 255},
+  {  1,   3, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   3, 255, 255, 255, 255, 255},
+  {  2,   3, 255, 255, 255, 255, 255, 255},
+  {  0,   2,   3, 255, 255, 255, 255, 255},
+  {  1,   2,   3, 255, 255, 255, 255, 255},
+  {  0,   1,   2,   3, 255, 255, 255, 255},
+  {  4, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   4, 255, 255, 255, 255, 255, 255},
+  {  1,   4, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   4, 255, 255, 255, 255, 255},
+  {  2,   4, 255, 255, 255, 255, 255, 255},
+  {  0,   2,   4, 255, 255, 255, 255, 255},
+  {  1,   2,   4, 255, 255, 255, 255, 255},
+  {  0,   1,   2,   4, 255, 255, 255, 255},
+  {  3,   4, 255, 255, 255, 255, 255, 255},
+  {  0,   3,   4, 255, 255, 255, 255, 255},
+  {  1,   3,   4, 255, 255, 255, 255, 255},
+  {  0,   1,   3,   4, 255, 255, 255, 255},
+  {  2,   3,   4, 255, 255, 255, 255, 255},
+  {  0,   2,   3,   4, 255, 255, 255, 255},
+  {  1,   2,   3,   4, 255, 255, 255, 255},
+  {  0,   1,   2,   3,   4, 255, 255, 255},
+  {  5, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   5, 255, 255, 255, 255, 255, 255},
+  {  1,   5, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   5, 255, 255, 255, 255, 255},
+  {  2,   5, 255, 255, 255, 255, 255, 255},
+  {  0,   2,   5, 255, 255, 255, 255, 255},
+  {  1,   2,   5, 255, 255, 255, 255, 255},
+  {  0,   1,   2,   5, 255, 255, 255, 255},
+  {  3,   5, 255, 255, 255, 255, 255, 255},
+  {  0,   3,   5, 255, 255, 255, 255, 255},
+  {  1,   3,   5, 255, 255, 255, 255, 255},
+  {  0,   1,   3,   5, 255, 255, 255, 255},
+  {  2,   3,   5, 255, 255, 255, 255, 255},
+  {  0,   2,   3,   5, 255, 255, 255, 255},
+  {  1,   2,   3,   5, 255, 255, 255, 255},
+  {  0,   1,   2,   3,   5, 255, 255, 255},
+  {  4,   5, 255, 255, 255, 255, 255, 255},
+  {  0,   4,   5, 255, 255, 255, 255, 255},
+  {  1,   4,   5, 255, 255, 255, 255, 255},
+  {  0,   1,   4,   5, 255, 255, 255, 255},
+  {  2,   4,   5, 255, 255, 255, 255, 255},
+  {  0,   2,   4,   5, 255, 255, 255, 255},
+  {  1,   2,   4,   5, 255, 255, 255, 255},
+  {  0,   1,   2,   4,   5, 255, 255, 255},
+  {  3,   4,   5, 255, 255, 255, 255, 255},
+  {  0,   3,   4,   5, 255, 255, 255, 255},
+  {  1,   3,   4,   5, 255, 255, 255, 255},
+  {  0,   1,   3,   4,   5, 255, 255, 255},
+  {  2,   3,   4,   5, 255, 255, 255, 255},
+  {  0,   2,   3,   4,   5, 255, 255, 255},
+  {  1,   2,   3,   4,   5, 255, 255, 255},
+  {  0,   1,   2,   3,   4,   5, 255, 255},
+  {  6, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   6, 255, 255, 255, 255, 255, 255},
+  {  1,   6, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   6, 255, 255, 255, 255, 255},
+  {  2,   6, 255, 255, 255, 255, 255, 255},
+  {  0,   2,   6, 255, 255, 255, 255, 255},
+  {  1,   2,   6, 255, 255, 255, 255, 255},
+  {  0,   1,   2,   6, 255, 255, 255, 255},
+  {  3,   6, 255, 255, 255, 255, 255, 255},
+  {  0,   3,   6, 255, 255, 255, 255, 255},
+  {  1,   3,   6, 255, 255, 255, 255, 255},
+  {  0,   1,   3,   6, 255, 255, 255, 255},
+  {  2,   3,   6, 255, 255, 255, 255, 255},
+  {  0,   2,   3,   6, 255, 255, 255, 255},
+  {  1,   2,   3,   6, 255, 255, 255, 255},
+  {  0,   1,   2,   3,   6, 255, 255, 255},
+  {  4,   6, 255, 255, 255, 255, 255, 255},
+  {  0,   4,   6, 255, 255, 255, 255, 255},
+  {  1,   4,   6, 255, 255, 255, 255, 255},
+  {  0,   1,   4,   6, 255, 255, 255, 255},
+  {  2,   4,   6, 255, 255, 255, 255, 255},
+  {  0,   2,   4,   6, 255, 255, 255, 255},
+  {  1,   2,   4,   6, 255, 255, 255, 255},
+  {  0,   1,   2,   4,   6, 255, 255, 255},
+  {  3,   4,   6, 255, 255, 255, 255, 255},
+  {  0,   3,   4,   6, 255, 255, 255, 255},
+  {  1,   3,   4,   6, 255, 255, 255, 255},
+  {  0,   1,   3,   4,   6, 255, 255, 255},
+  {  2,   3,   4,   6, 255, 255, 255, 255},
+  {  0,   2,   3,   4,   6, 255, 255, 255},
+  {  1,   2,   3,   4,   6, 255, 255, 255},
+  {  0,   1,   2,   3,   4,   6, 255, 255},
+  {  5,   6, 255, 255, 255, 255, 255, 255},
+  {  0,   5,   6, 255, 255, 255, 255, 255},
+  {  1,   5,   6, 255, 255, 255, 255, 255},
+  {  0,   1,   5,   6, 255, 255, 255, 255},
+  {  2,   5,   6, 255, 255, 255, 255, 255},
+  {  0,   2,   5,   6, 255, 255, 255, 255},
+  {  1,   2,   5,   6, 255, 255, 255, 255},
+  {  0,   1,   2,   5,   6, 255, 255, 255},
+  {  3,   5,   6, 255, 255, 255, 255, 255},
+  {  0,   3,   5,   6, 255, 255, 255, 255},
+  {  1,   3,   5,   6, 255, 255, 255, 255},
+  {  0,   1,   3,   5,   6, 255, 255, 255},
+  {  2,   3,   5,   6, 255, 255, 255, 255},
+  {  0,   2,   3,   5,   6, 255, 255, 255},
+  {  1,   2,   3,   5,   6, 255, 255, 255},
+  {  0,   1,   2,   3,   5,   6, 255, 255},
+  {  4,   5,   6, 255, 255, 255, 255, 255},
+  {  0,   4,   5,   6, 255, 255, 255, 255},
+  {  1,   4,   5,   6, 255, 255, 255, 255},
+  {  0,   1,   4,   5,   6, 255, 255, 255},
+  {  2,   4,   5,   6, 255, 255, 255, 255},
+  {  0,   2,   4,   5,   6, 255, 255, 255},
+  {  1,   2,   4,   5,   6, 255, 255, 255},
+  {  0,   1,   2,   4,   5,   6, 255, 255},
+  {  3,   4,   5,   6, 255, 255, 255, 255},
+  {  0,   3,   4,   5,   6, 255, 255, 255},
+  {  1,   3,   4,   5,   6, 255, 255, 255},
+  {  0,   1,   3,   4,   5,   6, 255, 255},
+  {  2,   3,   4,   5,   6, 255, 255, 255},
+  {  0,   2,   3,   4,   5,   6, 255, 255},
+  {  1,   2,   3,   4,   5,   6, 255, 255},
+  {  0,   1,   2,   3,   4,   5,   6, 255},
+  {  7, 255, 255, 255, 255, 255, 255, 255},
+  {  0,   7, 255, 255, 255, 255, 255, 255},
+  {  1,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   1,   7, 255, 255, 255, 255, 255},
+  {  2,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   2,   7, 255, 255, 255, 255, 255},
+  {  1,   2,   7, 255, 255, 255, 255, 255},
+  {  0,   1,   2,   7, 255, 255, 255, 255},
+  {  3,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   3,   7, 255, 255, 255, 255, 255},
+  {  1,   3,   7, 255, 255, 255, 255, 255},
+  {  0,   1,   3,   7, 255, 255, 255, 255},
+  {  2,   3,   7, 255, 255, 255, 255, 255},
+  {  0,   2,   3,   7, 255, 255, 255, 255},
+  {  1,   2,   3,   7, 255, 255, 255, 255},
+  {  0,   1,   2,   3,   7, 255, 255, 255},
+  {  4,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   4,   7, 255, 255, 255, 255, 255},
+  {  1,   4,   7, 255, 255, 255, 255, 255},
+  {  0,   1,   4,   7, 255, 255, 255, 255},
+  {  2,   4,   7, 255, 255, 255, 255, 255},
+  {  0,   2,   4,   7, 255, 255, 255, 255},
+  {  1,   2,   4,   7, 255, 255, 255, 255},
+  {  0,   1,   2,   4,   7, 255, 255, 255},
+  {  3,   4,   7, 255, 255, 255, 255, 255},
+  {  0,   3,   4,   7, 255, 255, 255, 255},
+  {  1,   3,   4,   7, 255, 255, 255, 255},
+  {  0,   1,   3,   4,   7, 255, 255, 255},
+  {  2,   3,   4,   7, 255, 255, 255, 255},
+  {  0,   2,   3,   4,   7, 255, 255, 255},
+  {  1,   2,   3,   4,   7, 255, 255, 255},
+  {  0,   1,   2,   3,   4,   7, 255, 255},
+  {  5,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   5,   7, 255, 255, 255, 255, 255},
+  {  1,   5,   7, 255, 255, 255, 255, 255},
+  {  0,   1,   5,   7, 255, 255, 255, 255},
+  {  2,   5,   7, 255, 255, 255, 255, 255},
+  {  0,   2,   5,   7, 255, 255, 255, 255},
+  {  1,   2,   5,   7, 255, 255, 255, 255},
+  {  0,   1,   2,   5,   7, 255, 255, 255},
+  {  3,   5,   7, 255, 255, 255, 255, 255},
+  {  0,   3,   5,   7, 255, 255, 255, 255},
+  {  1,   3,   5,   7, 255, 255, 255, 255},
+  {  0,   1,   3,   5,   7, 255, 255, 255},
+  {  2,   3,   5,   7, 255, 255, 255, 255},
+  {  0,   2,   3,   5,   7, 255, 255, 255},
+  {  1,   2,   3,   5,   7, 255, 255, 255},
+  {  0,   1,   2,   3,   5,   7, 255, 255},
+  {  4,   5,   7, 255, 255, 255, 255, 255},
+  {  0,   4,   5,   7, 255, 255, 255, 255},
+  {  1,   4,   5,   7, 255, 255, 255, 255},
+  {  0,   1,   4,   5,   7, 255, 255, 255},
+  {  2,   4,   5,   7, 255, 255, 255, 255},
+  {  0,   2,   4,   5,   7, 255, 255, 255},
+  {  1,   2,   4,   5,   7, 255, 255, 255},
+  {  0,   1,   2,   4,   5,   7, 255, 255},
+  {  3,   4,   5,   7, 255, 255, 255, 255},
+  {  0,   3,   4,   5,   7, 255, 255, 255},
+  {  1,   3,   4,   5,   7, 255, 255, 255},
+  {  0,   1,   3,   4,   5,   7, 255, 255},
+  {  2,   3,   4,   5,   7, 255, 255, 255},
+  {  0,   2,   3,   4,   5,   7, 255, 255},
+  {  1,   2,   3,   4,   5,   7, 255, 255},
+  {  0,   1,   2,   3,   4,   5,   7, 255},
+  {  6,   7, 255, 255, 255, 255, 255, 255},
+  {  0,   6,   7, 255, 255, 255, 255, 255},
+  {  1,   6,   7, 255, 255, 255, 255, 255},
+  {  0,   1,   6,   7, 255, 255, 255, 255},
+  {  2,   6,   7, 255, 255, 255, 255, 255},
+  {  0,   2,   6,   7, 255, 255, 255, 255},
+  {  1,   2,   6,   7, 255, 255, 255, 255},
+  {  0,   1,   2,   6,   7, 255, 255, 255},
+  {  3,   6,   7, 255, 255, 255, 255, 255},
+  {  0,   3,   6,   7, 255, 255, 255, 255},
+  {  1,   3,   6,   7, 255, 255, 255, 255},
+  {  0,   1,   3,   6,   7, 255, 255, 255},
+  {  2,   3,   6,   7, 255, 255, 255, 255},
+  {  0,   2,   3,   6,   7, 255, 255, 255},
+  {  1,   2,   3,   6,   7, 255, 255, 255},
+  {  0,   1,   2,   3,   6,   7, 255, 255},
+  {  4,   6,   7, 255, 255, 255, 255, 255},
+  {  0,   4,   6,   7, 255, 255, 255, 255},
+  {  1,   4,   6,   7, 255, 255, 255, 255},
+  {  0,   1,   4,   6,   7, 255, 255, 255},
+  {  2,   4,   6,   7, 255, 255, 255, 255},
+  {  0,   2,   4,   6,   7, 255, 255, 255},
+  {  1,   2,   4,   6,   7, 255, 255, 255},
+  {  0,   1,   2,   4,   6,   7, 255, 255},
+  {  3,   4,   6,   7, 255, 255, 255, 255},
+  {  0,   3,   4,   6,   7, 255, 255, 255},
+  {  1,   3,   4,   6,   7, 255, 255, 255},
+  {  0,   1,   3,   4,   6,   7, 255, 255},
+  {  2,   3,   4,   6,   7, 255, 255, 255},
+  {  0,   2,   3,   4,   6,   7, 255, 255},
+  {  1,   2,   3,   4,   6,   7, 255, 255},
+  {  0,   1,   2,   3,   4,   6,   7, 255},
+  {  5,   6,   7, 255, 255, 255, 255, 255},
+  {  0,   5,   6,   7, 255, 255, 255, 255},
+  {  1,   5,   6,   7, 255, 255, 255, 255},
+  {  0,   1,   5,   6,   7, 255, 255, 255},
+  {  2,   5,   6,   7, 255, 255, 255, 255},
+  {  0,   2,   5,   6,   7, 255, 255, 255},
+  {  1,   2,   5,   6,   7, 255, 255, 255},
+  {  0,   1,   2,   5,   6,   7, 255, 255},
+  {  3,   5,   6,   7, 255, 255, 255, 255},
+  {  0,   3,   5,   6,   7, 255, 255, 255},
+  {  1,   3,   5,   6,   7, 255, 255, 255},
+  {  0,   1,   3,   5,   6,   7, 255, 255},
+  {  2,   3,   5,   6,   7, 255, 255, 255},
+  {  0,   2,   3,   5,   6,   7, 255, 255},
+  {  1,   2,   3,   5,   6,   7, 255, 255},
+  {  0,   1,   2,   3,   5,   6,   7, 255},
+  {  4,   5,   6,   7, 255, 255, 255, 255},
+  {  0,   4,   5,   6,   7, 255, 255, 255},
+  {  1,   4,   5,   6,   7, 255, 255, 255},
+  {  0,   1,   4,   5,   6,   7, 255, 255},
+  {  2,   4,   5,   6,   7, 255, 255, 255},
+  {  0,   2,   4,   5,   6,   7, 255, 255},
+  {  1,   2,   4,   5,   6,   7, 255, 255},
+  {  0,   1,   2,   4,   5,   6,   7, 255},
+  {  3,   4,   5,   6,   7, 255, 255, 255},
+  {  0,   3,   4,   5,   6,   7, 255, 255},
+  {  1,   3,   4,   5,   6,   7, 255, 255},
+  {  0,   1,   3,   4,   5,   6,   7, 255},
+  {  2,   3,   4,   5,   6,   7, 255, 255},
+  {  0,   2,   3,   4,   5,   6,   7, 255},
+  {  1,   2,   3,   4,   5,   6,   7, 255},
+  {  0,   1,   2,   3,   4,   5,   6,   7}
+};
+
+/*************************************************
+* Name:        rej_uniform_avx2
+*
+* Description: AVX2 part of rej_uniform (host only). While at least 16
+*              outputs fit, 24 bytes are split into 16 candidates of 12
+*              bits; the accepted ones of each half are moved to the front
+*              with a VPSHUFB mask from rej_idx and stored, so candidates
+*              are accepted in the same order as by the C code. Stops
+*              early enough that the last 32-byte load stays in buf; the
+*              caller samples the rest.
+*
+* Arguments:   - int16_t *r: pointer to output buffer
+*              - unsigned int len: requested number of 16-bit integers (uniform mod q)
+*              - const uint8_t *buf: pointer to input buffer (assumed to be uniformly random bytes)
+*              - unsigned int buflen: length of input buffer in bytes
+*              - unsigned int *pos: set to the number of bytes consumed
+*
+* Returns number of sampled 16-bit integers (at most len)
+**************************************************/
+unsigned int rej_uniform_avx2(int16_t *r,
+                              unsigned int len,
+                              const uint8_t *buf,
+                              unsigned int buflen,
+                              unsigned int *pos)
+{
+  unsigned int ctr, good;
+  const __m256i bound = _mm256_set1_epi16(KYBER_Q);
+  const __m256i mask = _mm256_set1_epi16(0xFFF);
+  const __m256i idx8 = _mm256_setr_epi8(0,1,1,2,3,4,4,5,6,7,7,8,9,10,10,11,
+                                        4,5,5,6,7,8,8,9,10,11,11,12,13,14,14,15);
+  const __m128i ones = _mm_set1_epi16(0x0100);
+  __m256i f, g;
+  __m128i c0, c1, v0, v1;
+
+  ctr = 0;
+  *pos = 0;
+  while(ctr + 16 <= len && *pos + 32 <= buflen) {
+    // bytes 0-15 and 8-23 in the two lanes, then one 16-bit window per candidate
+    f = _mm256_loadu_si256((const __m256i *)&buf[*pos]);
+    f = _mm256_permute4x64_epi64(f, 0x94);
+    f = _mm256_shuffle_epi8(f, idx8);
+    f = _mm256_blend_epi16(_mm256_and_si256(f, mask), _mm256_srli_epi16(f, 4), 0xAA);
+    *pos += 24;
+
+    g = _mm256_cmpgt_epi16(bound, f);
+    g = _mm256_packs_epi16(g, g);
+    good = (unsigned int)_mm256_movemask_epi8(g);
+
+    c0 = _mm_loadl_epi64((const __m128i *)rej_idx[good & 0xFF]);
+    c1 = _mm_loadl_epi64((const __m128i *)rej_idx[(good >> 16) & 0xFF]);
+    c0 = _mm_unpacklo_epi8(c0, c0);
+    c1 = _mm_unpacklo_epi8(c1, c1);
+    c0 = _mm_add_epi8(_mm_add_epi8(c0, c0), ones);
+    c1 = _mm_add_epi8(_mm_add_epi8(c1, c1), ones);
+
+    v0 = _mm_shuffle_epi8(_mm256_castsi256_si128(f), c0);
+    v1 = _mm_shuffle_epi8(_mm256_extracti128_si256(f, 1), c1);
+    _mm_storeu_si128((__m128i *)&r[ctr], v0);
+    ctr += (unsigned int)__builtin_popcount(good & 0xFF);
+    _mm_storeu_si128((__m128i *)&r[ctr], v1);
+    ctr += (unsigned int)__builtin_popcount((good >> 16) & 0xFF);
+  }
+
+  return ctr;
+}
+#endif
@@ -5,6 +5,7 @@
 #include "symmetric.h"
 #include "fips202.h"
 
+#if !defined(KYBER_MULTILEVEL_NO_SHARED)
 /*************************************************
 * Name:        kyber_shake128_absorb
 *
@@ -50,6 +51,37 @@ void kyber_shake256_prf(uint8_t *out, size_t outlen, const uint8_t key[KYBER_SYM
   shake256(out, outlen, extkey, sizeof(extkey));
 }
 
+/*************************************************
+* Name:        kyber_shake256_rkprf_init
+*
+* Description: Starts an incremental kyber_shake256_rkprf: initializes the
+*              state and absorbs the key; the input is absorbed with
+*              shake256_absorb as it arrives
+*
+* Arguments:   - keccak_state *s: pointer to (uninitialized) Keccak state
+*              - const uint8_t *key: pointer to the key (of length KYBER_SYMBYTES)
+**************************************************/
+void kyber_shake256_rkprf_init(keccak_state *s, const uint8_t key[KYBER_SYMBYTES])
+{
+  shake256_init(s);
+  shake256_absorb(s, key, KYBER_SYMBYTES);
+}
+
+/*************************************************
+* Name:        kyber_shake256_rkprf_finalize
+*
+* Description: Finishes an incremental kyber_shake256_rkprf
+*
+* Arguments:   - uint8_t *out: pointer to output (of length KYBER_SSBYTES)
+*              - keccak_state *s: pointer to Keccak state
+**************************************************/
+void kyber_shake256_rkprf_finalize(uint8_t out[KYBER_SSBYTES], keccak_state *s)
+{
+  shake256_finalize(s);
+  shake256_squeeze(out, KYBER_SSBYTES, s);
+}
+#endif
+
 /*************************************************
 * Name:        kyber_shake256_prf
 *
@@ -9,18 +9,24 @@
 
 typedef keccak_state xof_state;
 
-#define kyber_shake128_absorb KYBER_NAMESPACE(kyber_shake128_absorb)
+#define kyber_shake128_absorb KYBER_SHARED_NAMESPACE(kyber_shake128_absorb)
 void kyber_shake128_absorb(keccak_state *s,
                            const uint8_t seed[KYBER_SYMBYTES],
                            uint8_t x,
                            uint8_t y);
 
-#define kyber_shake256_prf KYBER_NAMESPACE(kyber_shake256_prf)
+#define kyber_shake256_prf KYBER_SHARED_NAMESPACE(kyber_shake256_prf)
 void kyber_shake256_prf(uint8_t *out, size_t outlen, const uint8_t key[KYBER_SYMBYTES], uint8_t nonce);
 
 #define kyber_shake256_rkprf KYBER_NAMESPACE(kyber_shake256_rkprf)
 void kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SYMBYTES], const uint8_t input[KYBER_CIPHERTEXTBYTES]);
 
+#define kyber_shake256_rkprf_init KYBER_SHARED_NAMESPACE(kyber_shake256_rkprf_init)
+void kyber_shake256_rkprf_init(keccak_state *s, const uint8_t key[KYBER_SYMBYTES]);
+
+#define kyber_shake256_rkprf_finalize KYBER_SHARED_NAMESPACE(kyber_shake256_rkprf_finalize)
+void kyber_shake256_rkprf_finalize(uint8_t out[KYBER_SSBYTES], keccak_state *s);
+
 #define XOF_BLOCKBYTES SHAKE128_RATE
 
 #define hash_h(OUT, IN, INBYTES) sha3_256(OUT, IN, INBYTES)
@@ -30,4 +36,12 @@ void kyber_shake256_rkprf(uint8_t out[KYBER_SSBYTES], const uint8_t key[KYBER_SY
 #define prf(OUT, OUTBYTES, KEY, NONCE) kyber_shake256_prf(OUT, OUTBYTES, KEY, NONCE)
 #define rkprf(OUT, KEY, INPUT) kyber_shake256_rkprf(OUT, KEY, INPUT)
 
+/* incremental versions for input that arrives in chunks */
+#define hash_h_init(STATE) sha3_256_init(STATE)
+#define hash_h_absorb(STATE, IN, INBYTES) sha3_256_absorb(STATE, IN, INBYTES)
+#define hash_h_finalize(OUT, STATE) sha3_256_finalize(OUT, STATE)
+#define rkprf_init(STATE, KEY) kyber_shake256_rkprf_init(STATE, KEY)
+#define rkprf_absorb(STATE, IN, INBYTES) shake256_absorb(STATE, IN, INBYTES)
+#define rkprf_finalize(OUT, STATE) kyber_shake256_rkprf_finalize(OUT, STATE)
+
 #endif /* SYMMETRIC_H */
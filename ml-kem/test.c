@@ -6,6 +6,13 @@
 #include "hal.h"
 #include "randombytes.h"
 #include "poly.h"
+#include "kem_prepared.h"
+#include "kem_seed.h"
+#include "kem_stream.h"
+#include "fips202.h"
+#if defined(KYBER_BATCH)
+#include "kem_batch.h"
+#endif
 
 #include "testvectors.inc"
 
@@ -103,6 +110,404 @@ static int test_decaps_vector(void)
     return 0;
 }
 
+static int test_encaps_prepared_vector(void)
+{
+    static crypto_kem_enc_ctx ctx;
+    uint8_t ct[pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
+    uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    int i;
+
+    hal_send_str("\n=== Test 5: Prepared Encapsulation ===\n");
+
+    // Expand the test vector public key once, then encapsulate twice
+    crypto_kem_enc_prepare(&ctx, tv_encaps_pk);
+    for(i = 0; i < 2; i++) {
+        if(crypto_kem_enc_prepared_derand(ct, ss, &ctx, tv_encaps_coins) != 0) {
+            hal_send_str("Prepared encapsulation failed!\n");
+            return -1;
+        }
+        if(memcmp(ct, tv_expected_ct, sizeof(ct)) != 0) {
+            hal_send_str("Ciphertext mismatch!\n");
+            return -1;
+        }
+        if(memcmp(ss, tv_expected_ss_encaps, sizeof(ss)) != 0) {
+            hal_send_str("Shared secret mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Prepared encapsulation test vector PASSED\n");
+    return 0;
+}
+
+static int test_decaps_prepared_vector(void)
+{
+    static crypto_kem_dec_ctx ctx;
+    uint8_t ct[pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
+    uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    uint8_t ss_ref[pqcrystals_kyber768_ref_BYTES];
+
+    hal_send_str("\n=== Test 6: Prepared Decapsulation ===\n");
+
+    crypto_kem_dec_prepare(&ctx, tv_decaps_sk);
+    if(crypto_kem_dec_prepared(ss, tv_decaps_ct, &ctx) != 0) {
+        hal_send_str("Prepared decapsulation failed!\n");
+        return -1;
+    }
+    if(memcmp(ss, tv_expected_ss_decaps, sizeof(ss)) != 0) {
+        hal_send_str("Shared secret mismatch!\n");
+        return -1;
+    }
+
+    // A modified ciphertext has to give the same implicit rejection key
+    memcpy(ct, tv_decaps_ct, sizeof(ct));
+    ct[0] ^= 1;
+    crypto_kem_dec_prepared(ss, ct, &ctx);
+    pqcrystals_kyber768_ref_dec(ss_ref, ct, tv_decaps_sk);
+    if(memcmp(ss, ss_ref, sizeof(ss)) != 0 || memcmp(ss, tv_expected_ss_decaps, sizeof(ss)) == 0) {
+        hal_send_str("Implicit rejection mismatch!\n");
+        return -1;
+    }
+
+    hal_send_str("✓ Prepared decapsulation test vector PASSED\n");
+    return 0;
+}
+
+static int test_seed_keys(void)
+{
+    static crypto_kem_dec_ctx ctx;
+    static uint8_t sk[pqcrystals_kyber768_ref_SECRETKEYBYTES];
+    uint8_t pk[pqcrystals_kyber768_ref_PUBLICKEYBYTES];
+    uint8_t seed[KYBER_SEEDKEYBYTES];
+    uint8_t ct[pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
+    uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    uint8_t ss_ref[pqcrystals_kyber768_ref_BYTES];
+    int i;
+
+    hal_send_str("\n=== Test 7: Seed-Format Private Keys ===\n");
+
+    // The seed of the test vector key has to expand to the test vector keys
+    crypto_kem_keypair_seed_derand(pk, seed, tv_keypair_coins);
+    crypto_kem_seed_expand(sk, seed);
+    if(memcmp(pk, tv_expected_pk, sizeof(pk)) != 0 ||
+       memcmp(sk, tv_expected_sk, sizeof(sk)) != 0) {
+        hal_send_str("Expanded key mismatch!\n");
+        return -1;
+    }
+
+    // Decapsulation from the seed, directly and through the cached
+    // expansion, including implicit rejection
+    crypto_kem_dec_prepare_seed(&ctx, seed);
+    for(i = 0; i < 2; i++) {
+        pqcrystals_kyber768_ref_enc(ct, ss_ref, pk);
+        ct[0] ^= i;
+        if(i)
+            pqcrystals_kyber768_ref_dec(ss_ref, ct, sk);
+        crypto_kem_dec_seed(ss, ct, seed);
+        if(memcmp(ss, ss_ref, sizeof(ss)) != 0) {
+            hal_send_str("Seed decapsulation mismatch!\n");
+            return -1;
+        }
+        crypto_kem_dec_prepared(ss, ct, &ctx);
+        if(memcmp(ss, ss_ref, sizeof(ss)) != 0) {
+            hal_send_str("Cached seed decapsulation mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Seed-format private keys PASSED\n");
+    return 0;
+}
+
+/* Chunk lengths of the incremental tests: 1 to 97 bytes, so that chunks
+ * start and end inside and across polynomials */
+static size_t chunk_len(size_t i, size_t left)
+{
+    size_t n = (i*37) % 97 + 1;
+    return n < left ? n : left;
+}
+
+static int test_stream_vector(void)
+{
+    static crypto_kem_enc_stream_ctx enc_ctx;
+    static crypto_kem_dec_stream_ctx dec_ctx;
+    uint8_t ct[pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
+    uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    uint8_t ss_ref[pqcrystals_kyber768_ref_BYTES];
+    size_t i, pos, n;
+    int j;
+
+    hal_send_str("\n=== Test 8: Incremental Encapsulation and Decapsulation ===\n");
+
+    crypto_kem_enc_init(&enc_ctx);
+    for(i = 0, pos = 0; pos < sizeof(tv_encaps_pk); i++, pos += n) {
+        n = chunk_len(i, sizeof(tv_encaps_pk) - pos);
+        crypto_kem_enc_update(&enc_ctx, tv_encaps_pk + pos, n);
+    }
+    if(crypto_kem_enc_update(&enc_ctx, tv_encaps_pk, 1) == 0 ||
+       crypto_kem_enc_final_derand(ct, ss, &enc_ctx, tv_encaps_coins) != 0) {
+        hal_send_str("Incremental encapsulation failed!\n");
+        return -1;
+    }
+    if(memcmp(ct, tv_expected_ct, sizeof(ct)) != 0 ||
+       memcmp(ss, tv_expected_ss_encaps, sizeof(ss)) != 0) {
+        hal_send_str("Incremental encapsulation mismatch!\n");
+        return -1;
+    }
+
+    // Test vector ciphertext, then a modified one for implicit rejection
+    memcpy(ct, tv_decaps_ct, sizeof(ct));
+    for(j = 0; j < 2; j++) {
+        ct[sizeof(ct) - 1] ^= j;
+        crypto_kem_dec_init(&dec_ctx, tv_decaps_sk);
+        if(crypto_kem_dec_final(ss, &dec_ctx) == 0) {
+            hal_send_str("Incomplete ciphertext accepted!\n");
+            return -1;
+        }
+        for(i = 0, pos = 0; pos < sizeof(ct); i++, pos += n) {
+            n = chunk_len(i, sizeof(ct) - pos);
+            crypto_kem_dec_update(&dec_ctx, ct + pos, n);
+        }
+        if(crypto_kem_dec_final(ss, &dec_ctx) != 0) {
+            hal_send_str("Incremental decapsulation failed!\n");
+            return -1;
+        }
+        pqcrystals_kyber768_ref_dec(ss_ref, ct, tv_decaps_sk);
+        if(memcmp(ss, ss_ref, sizeof(ss)) != 0 ||
+           (memcmp(ss, tv_expected_ss_decaps, sizeof(ss)) == 0) != (j == 0)) {
+            hal_send_str("Incremental decapsulation mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Incremental encapsulation and decapsulation PASSED\n");
+    return 0;
+}
+
+/* Fills a with coefficients in {-bound+1,...,bound-1}; test 0 and 1 use
+ * the extremes */
+static void fill_poly(poly *a, int16_t bound, int it)
+{
+    uint16_t r[KYBER_N];
+    int i;
+
+    randombytes((uint8_t *)r, sizeof(r));
+    for(i = 0; i < KYBER_N; i++) {
+        if(it == 0) {
+            a->coeffs[i] = bound - 1;
+        } else if(it == 1) {
+            a->coeffs[i] = -bound + 1;
+        } else {
+            a->coeffs[i] = (int16_t)(r[i] % (2*bound - 1)) - (bound - 1);
+        }
+    }
+}
+
+/* The fused kernels (Cortex-M4 assembly or AVX2 where available) against
+ * the same steps done one after the other */
+static int test_fused_kernels(void)
+{
+    uint8_t buf[KYBER_POLYCOMPRESSEDBYTES_DU];
+    uint8_t out1[KYBER_POLYCOMPRESSEDBYTES_DU];
+    uint8_t out2[KYBER_POLYCOMPRESSEDBYTES_DU];
+    poly a, b, e;
+    int i, it;
+
+    hal_send_str("\n=== Test 11: Fused Polynomial Kernels ===\n");
+
+    for(it = 0; it < 16; it++) {
+        randombytes(buf, sizeof(buf));
+        if(it == 0) {
+            memset(buf, 0xff, sizeof(buf));
+        }
+        poly_decompress_du_ntt(&a, buf);
+        poly_decompress_du(&b, buf);
+        poly_ntt(&b);
+        if(memcmp(&a, &b, sizeof(a)) != 0) {
+            hal_send_str("poly_decompress_du_ntt mismatch!\n");
+            return -1;
+        }
+
+        // u = invntt(a) + e1 with |e1| <= ETA2
+        fill_poly(&a, KYBER_Q, it);
+        fill_poly(&e, KYBER_ETA2 + 1, it);
+        b = a;
+        poly_invntt_add_compress_du(out1, &a, &e);
+        poly_invntt_tomont(&b);
+        poly_add(&b, &b, &e);
+        poly_compress_du(out2, &b);
+        if(memcmp(out1, out2, KYBER_POLYCOMPRESSEDBYTES_DU) != 0) {
+            hal_send_str("poly_invntt_add_compress_du mismatch!\n");
+            return -1;
+        }
+
+        // v = invntt(a) + e2 + m with m in {0, (q+1)/2}
+        fill_poly(&a, KYBER_Q, it);
+        fill_poly(&e, KYBER_ETA2 + 1, it);
+        for(i = 0; i < KYBER_N; i++) {
+            e.coeffs[i] += (buf[i % sizeof(buf)] & 1) * ((KYBER_Q+1)/2);
+        }
+        b = a;
+        poly_invntt_add_compress(out1, &a, &e);
+        poly_invntt_tomont(&b);
+        poly_add(&b, &b, &e);
+        poly_compress(out2, &b);
+        if(memcmp(out1, out2, KYBER_POLYCOMPRESSEDBYTES) != 0) {
+            hal_send_str("poly_invntt_add_compress mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Fused polynomial kernels PASSED\n");
+    return 0;
+}
+
+#if defined(KYBER_MULTILEVEL)
+/* SHA3-256 of pk || sk || ct || ss || ss' for the coins 0, 1, ..., 63, where
+ * ss' is the implicit rejection of ct with its first bit flipped; computed
+ * independently from FIPS 203 */
+static const uint8_t tv_kat_hash_512[32] = {
+    0xc6, 0xa1, 0x96, 0xb7, 0x1e, 0xc7, 0x93, 0xb9,
+    0x6a, 0x87, 0xf0, 0x9d, 0x0f, 0xf9, 0x83, 0x72,
+    0x65, 0x60, 0x07, 0x23, 0x51, 0xf1, 0x95, 0x01,
+    0x0f, 0x7e, 0x03, 0xfc, 0x1f, 0x92, 0xc8, 0x1f
+};
+
+static const uint8_t tv_kat_hash_1024[32] = {
+    0x15, 0xd1, 0x52, 0x77, 0x3d, 0x7a, 0x6a, 0xa2,
+    0xfb, 0xba, 0xa7, 0x72, 0x30, 0x67, 0x2f, 0xd0,
+    0xda, 0x15, 0xc8, 0x94, 0x87, 0xdc, 0x97, 0x9c,
+    0x97, 0xcf, 0x79, 0x22, 0xfe, 0xbb, 0x31, 0xd8
+};
+
+/* Known answer and round trip with implicit rejection through the API of
+ * one parameter set; the buffers are sized for ML-KEM-1024 */
+static int test_level(const char *name,
+                      size_t pklen, size_t sklen, size_t ctlen,
+                      const uint8_t expected[32],
+                      int (*keypair_derand)(uint8_t *, uint8_t *, const uint8_t *),
+                      int (*enc_derand)(uint8_t *, uint8_t *, const uint8_t *, const uint8_t *),
+                      int (*dec)(uint8_t *, const uint8_t *, const uint8_t *))
+{
+    static uint8_t pk[pqcrystals_kyber1024_ref_PUBLICKEYBYTES];
+    static uint8_t sk[pqcrystals_kyber1024_ref_SECRETKEYBYTES];
+    static uint8_t ct[pqcrystals_kyber1024_ref_CIPHERTEXTBYTES];
+    uint8_t ss1[pqcrystals_kyber1024_ref_BYTES];
+    uint8_t ss2[pqcrystals_kyber1024_ref_BYTES];
+    uint8_t coins[pqcrystals_kyber1024_ref_KEYPAIRCOINBYTES];
+    uint8_t hash[32];
+    keccak_state state;
+    char str[100];
+    int i;
+
+    for(i = 0; i < pqcrystals_kyber1024_ref_KEYPAIRCOINBYTES; i++) {
+        coins[i] = i;
+    }
+
+    if(keypair_derand(pk, sk, coins) != 0 ||
+       enc_derand(ct, ss1, pk, coins) != 0 ||
+       dec(ss2, ct, sk) != 0 ||
+       memcmp(ss1, ss2, sizeof(ss1)) != 0) {
+        sprintf(str, "%s: shared secrets don't match!\n", name);
+        hal_send_str(str);
+        return -1;
+    }
+
+    ct[0] ^= 1;
+    if(dec(ss2, ct, sk) != 0 || memcmp(ss1, ss2, sizeof(ss1)) == 0) {
+        sprintf(str, "%s: modified ciphertext was not rejected!\n", name);
+        hal_send_str(str);
+        return -1;
+    }
+    ct[0] ^= 1;
+
+    sha3_256_init(&state);
+    sha3_256_absorb(&state, pk, pklen);
+    sha3_256_absorb(&state, sk, sklen);
+    sha3_256_absorb(&state, ct, ctlen);
+    sha3_256_absorb(&state, ss1, sizeof(ss1));
+    sha3_256_absorb(&state, ss2, sizeof(ss2));
+    sha3_256_finalize(hash, &state);
+    if(memcmp(hash, expected, sizeof(hash)) != 0) {
+        sprintf(str, "%s: known answer mismatch!\n", name);
+        hal_send_str(str);
+        return -1;
+    }
+
+    sprintf(str, "✓ %s known answer and functional test PASSED\n", name);
+    hal_send_str(str);
+    return 0;
+}
+
+/* The other parameter sets linked into the same image */
+static int test_multilevel(void)
+{
+    hal_send_str("\n=== Test 9: ML-KEM-512 and ML-KEM-1024 ===\n");
+    if(test_level("ML-KEM-512", pqcrystals_kyber512_ref_PUBLICKEYBYTES,
+                  pqcrystals_kyber512_ref_SECRETKEYBYTES, pqcrystals_kyber512_ref_CIPHERTEXTBYTES,
+                  tv_kat_hash_512, pqcrystals_kyber512_ref_keypair_derand,
+                  pqcrystals_kyber512_ref_enc_derand, pqcrystals_kyber512_ref_dec) != 0)
+        return -1;
+    return test_level("ML-KEM-1024", pqcrystals_kyber1024_ref_PUBLICKEYBYTES,
+                      pqcrystals_kyber1024_ref_SECRETKEYBYTES, pqcrystals_kyber1024_ref_CIPHERTEXTBYTES,
+                      tv_kat_hash_1024, pqcrystals_kyber1024_ref_keypair_derand,
+                      pqcrystals_kyber1024_ref_enc_derand, pqcrystals_kyber1024_ref_dec);
+}
+#endif
+
+#if defined(KYBER_BATCH)
+#define BATCH_N 64
+
+static uint8_t batch_pk[BATCH_N][pqcrystals_kyber768_ref_PUBLICKEYBYTES];
+static uint8_t batch_sk[BATCH_N][pqcrystals_kyber768_ref_SECRETKEYBYTES];
+static uint8_t batch_ct[BATCH_N][pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
+static uint8_t batch_ss[BATCH_N][pqcrystals_kyber768_ref_BYTES];
+static uint8_t batch_ss2[BATCH_N][pqcrystals_kyber768_ref_BYTES];
+
+/* Batch calls on a pool of four threads (independent of the number of
+ * CPUs), checked item by item against the single-shot API */
+static int test_batch(void)
+{
+    uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    int i;
+
+    hal_send_str("\n=== Test 10: Batch API on a Thread Pool ===\n");
+
+    if(crypto_kem_batch_start(4) != 0) {
+        hal_send_str("Could not start the thread pool!\n");
+        return -1;
+    }
+    if(crypto_kem_keypair_batch(batch_pk[0], batch_sk[0], BATCH_N) != 0 ||
+       crypto_kem_enc_batch(batch_ct[0], batch_ss[0], batch_pk[0], BATCH_N) != 0 ||
+       memcmp(batch_pk[0], batch_pk[1], sizeof(batch_pk[0])) == 0) {
+        hal_send_str("Batch keypair generation or encapsulation failed!\n");
+        crypto_kem_batch_stop();
+        return -1;
+    }
+
+    // Item 1 has to be rejected implicitly
+    batch_ct[1][0] ^= 1;
+    if(crypto_kem_dec_batch(batch_ss2[0], batch_ct[0], batch_sk[0], BATCH_N) != 0) {
+        hal_send_str("Batch decapsulation failed!\n");
+        crypto_kem_batch_stop();
+        return -1;
+    }
+    crypto_kem_batch_stop();
+
+    for(i = 0; i < BATCH_N; i++) {
+        pqcrystals_kyber768_ref_dec(ss, batch_ct[i], batch_sk[i]);
+        if(memcmp(ss, batch_ss2[i], sizeof(ss)) != 0 ||
+           (memcmp(ss, batch_ss[i], sizeof(ss)) == 0) != (i != 1)) {
+            hal_send_str("Batch decapsulation mismatch!\n");
+            return -1;
+        }
+    }
+
+    hal_send_str("✓ Batch API PASSED\n");
+    return 0;
+}
+#endif
+
 static int run_test(void)
 {
     uint8_t pk[pqcrystals_kyber768_ref_PUBLICKEYBYTES];
@@ -159,6 +564,11 @@ static void run_speed(void)
     uint8_t sk[pqcrystals_kyber768_ref_SECRETKEYBYTES];
     uint8_t ct[pqcrystals_kyber768_ref_CIPHERTEXTBYTES];
     uint8_t ss[pqcrystals_kyber768_ref_BYTES];
+    static crypto_kem_enc_ctx enc_ctx;
+    static crypto_kem_dec_ctx dec_ctx;
+    static polyvec matrix[KYBER_K];
+    uint8_t seed[KYBER_SYMBYTES];
+    uint8_t seedkey[KYBER_SEEDKEYBYTES];
     poly a;
     uint64_t cycles;
     char cycles_str[100];
@@ -166,6 +576,7 @@ static void run_speed(void)
     hal_send_str("\n=== Benchmarks ===\n");
 
     // poly_ntt benchmark
+    memset(&a, 0, sizeof(a));
     cycles = hal_get_time();
     poly_ntt(&a);
     cycles = hal_get_time() - cycles;
@@ -174,7 +585,21 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // gen_matrix benchmark
+    memset(seed, 0, sizeof(seed));
+    cycles = hal_get_time();
+    gen_matrix(matrix, seed, 0);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for gen_matrix: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -187,7 +612,7 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -200,7 +625,21 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // Prepared encapsulation benchmark (per-message work only)
+    crypto_kem_enc_prepare(&enc_ctx, pk);
+    cycles = hal_get_time();
+    crypto_kem_enc_prepared(ct, ss, &enc_ctx);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for prepared encapsulation: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
@@ -213,13 +652,79 @@ static void run_speed(void)
     (void)cycles;
     sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-    sprintf(cycles_str, "%llu\n", cycles);
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // Prepared decapsulation benchmark (per-ciphertext work only)
+    crypto_kem_dec_prepare(&dec_ctx, sk);
+    cycles = hal_get_time();
+    crypto_kem_dec_prepared(ss, ct, &dec_ctx);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for prepared decapsulation: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
+#endif
+    hal_send_str(cycles_str);
+
+    // Decapsulation from a seed-format private key (includes the expansion)
+    randombytes(seedkey, KYBER_SEEDKEYBYTES);
+    cycles = hal_get_time();
+    crypto_kem_dec_seed(ss, ct, seedkey);
+    cycles = hal_get_time() - cycles;
+    hal_send_str("cycles for seed-key decapsulation: ");
+#ifdef MPS2_AN386
+    (void)cycles;
+    sprintf(cycles_str, "[cycle counts not meaningful in qemu emulation]\n");
+#else
+    sprintf(cycles_str, "%llu\n", (unsigned long long)cycles);
 #endif
     hal_send_str(cycles_str);
 
     hal_send_str("Benchmarks completed!\n");
 }
 
+#if defined(KYBER_BATCH)
+/* Throughput of the batch calls for 1, 2, 4, ... threads up to one per
+ * online CPU, in wall-clock cycles per operation */
+static void run_batch_speed(void)
+{
+    unsigned int t, ncpu;
+    uint64_t cycles[3], total, base = 0;
+    char str[160];
+
+    hal_send_str("\n=== Batch Throughput ===\n");
+
+    crypto_kem_batch_start(0);
+    ncpu = crypto_kem_batch_threads();
+    for(t = 1; ; t = 2*t < ncpu ? 2*t : ncpu) {
+        crypto_kem_batch_start(t);
+        cycles[0] = hal_get_time();
+        crypto_kem_keypair_batch(batch_pk[0], batch_sk[0], BATCH_N);
+        cycles[1] = hal_get_time();
+        crypto_kem_enc_batch(batch_ct[0], batch_ss[0], batch_pk[0], BATCH_N);
+        cycles[2] = hal_get_time();
+        crypto_kem_dec_batch(batch_ss2[0], batch_ct[0], batch_sk[0], BATCH_N);
+        total = hal_get_time() - cycles[0];
+        if(t == 1)
+            base = total;
+        sprintf(str, "%u thread(s), cycles per operation: keypair %llu, encaps %llu, decaps %llu (speedup %llu.%02llu)\n", t,
+                (unsigned long long)(cycles[1] - cycles[0]) / BATCH_N,
+                (unsigned long long)(cycles[2] - cycles[1]) / BATCH_N,
+                (unsigned long long)(cycles[0] + total - cycles[2]) / BATCH_N,
+                (unsigned long long)(base / total),
+                (unsigned long long)((100*base / total) % 100));
+        hal_send_str(str);
+        if(t == ncpu)
+            break;
+    }
+    crypto_kem_batch_stop();
+}
+#endif
+
 static void run_stack(void)
 {
     uint8_t pk[pqcrystals_kyber768_ref_PUBLICKEYBYTES];
@@ -287,7 +792,42 @@ int main(void)
     hal_send_str("\n=== Test 4: Functional KEM Test ===\n");
     test_result = run_test();
 
+    // Fifth test: prepared encapsulation against the test vectors
+    if(test_result == 0)
+        test_result = test_encaps_prepared_vector();
+
+    // Sixth test: prepared decapsulation against the test vectors
+    if(test_result == 0)
+        test_result = test_decaps_prepared_vector();
+
+    // Seventh test: seed-format private keys
+    if(test_result == 0)
+        test_result = test_seed_keys();
+
+    // Eighth test: incremental encapsulation and decapsulation
+    if(test_result == 0)
+        test_result = test_stream_vector();
+
+#if defined(KYBER_MULTILEVEL)
+    // Ninth test: the other parameter sets of a multi-level build
+    if(test_result == 0)
+        test_result = test_multilevel();
+#endif
+
+#if defined(KYBER_BATCH)
+    // Tenth test: batch calls on a thread pool (host only)
+    if(test_result == 0)
+        test_result = test_batch();
+#endif
+
+    // Eleventh test: fused polynomial kernels against the separate steps
+    if(test_result == 0)
+        test_result = test_fused_kernels();
+
     run_speed();
+#if defined(KYBER_BATCH)
+    run_batch_speed();
+#endif
     run_stack();
 
     if(test_result != 0) {
@@ -5,13 +5,13 @@
 #include <stdint.h>
 #include "params.h"
 
-#define verify KYBER_NAMESPACE(verify)
+#define verify KYBER_SHARED_NAMESPACE(verify)
 int verify(const uint8_t *a, const uint8_t *b, size_t len);
 
-#define cmov KYBER_NAMESPACE(cmov)
+#define cmov KYBER_SHARED_NAMESPACE(cmov)
 void cmov(uint8_t *r, const uint8_t *x, size_t len, uint8_t b);
 
-#define cmov_int16 KYBER_NAMESPACE(cmov_int16)
+#define cmov_int16 KYBER_SHARED_NAMESPACE(cmov_int16)
 void cmov_int16(int16_t *r, int16_t v, uint16_t b);
 
 #endif
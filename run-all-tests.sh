@@ -1,6 +1,8 @@
 #!/bin/bash
 
 TEST_DIRS="shake256 ecdh25519 ml-kem ml-dsa"
+# qemu (default) or host
+PLATFORM=${PLATFORM:-qemu}
 FAILED=0
 
 for dir in $TEST_DIRS; do
@@ -8,7 +10,7 @@ for dir in $TEST_DIRS; do
     cd $dir
     make clean > /dev/null
     
-    if CFLAGS=-Werror make run-qemu PLATFORM=qemu | grep -q "ALL GOOD"; then
+    if CFLAGS=-Werror make run-$PLATFORM PLATFORM=$PLATFORM | grep -q "ALL GOOD"; then
         echo "$dir: PASSED"
     else
         echo "$dir: FAILED"
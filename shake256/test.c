@@ -111,7 +111,7 @@ static void run_speed(void)
   (void)oldcount; (void)newcount;
   sprintf(outstr, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-  sprintf(outstr, "%llu\n", newcount-oldcount);
+  sprintf(outstr, "%llu\n", (unsigned long long)(newcount-oldcount));
 #endif
   hal_send_str(outstr);
 
@@ -129,7 +129,7 @@ static void run_speed(void)
   (void)oldcount; (void)newcount;
   sprintf(outstr, "[cycle counts not meaningful in qemu emulation]\n");
 #else
-  sprintf(outstr, "%llu\n", newcount-oldcount);
+  sprintf(outstr, "%llu\n", (unsigned long long)(newcount-oldcount));
 #endif
   hal_send_str(outstr);
 